@@ -0,0 +1,115 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkBinaryBatchFunctorImageFilter_h
+#define itkBinaryBatchFunctorImageFilter_h
+
+#include "itkBinaryFunctorImageFilter.h"
+#include "itkImage.h"
+
+namespace itk
+{
+/** \class BinaryBatchFunctorImageFilter
+ * \brief Implements a pixel-wise operator on two images with a
+ * functor evaluated by scanlines.
+ *
+ * The functor must provide, in addition to the operator() used by
+ * BinaryFunctorImageFilter, the batch method
+ * \code
+ *   void Evaluate( const Input1PixelType *input1, const Input2PixelType *input2,
+ *                  OutputPixelType *output, SizeValueType count ) const;
+ * \endcode
+ * as the DivFloor and DivReal functors of this module do.
+ *
+ * When both inputs and the output are Images, each line of the output
+ * region is computed by one call to Evaluate on the contiguous
+ * buffers. The line is read at the same index in the inputs, whose
+ * buffered regions must contain the output region, as they do with
+ * the requested regions of BinaryFunctorImageFilter, otherwise an
+ * exception is thrown. Constant inputs and other image types, such as
+ * image adaptors, are computed pixel by pixel by
+ * BinaryFunctorImageFilter.
+ *
+ * \sa BinaryFunctorImageFilter
+ *
+ * \ingroup IntensityImageFilters MultiThreaded
+ * \ingroup SimpleITKFiltersModule
+ */
+template< typename TInputImage1, typename TInputImage2, typename TOutputImage, typename TFunction >
+class ITK_EXPORT BinaryBatchFunctorImageFilter:
+  public BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
+{
+public:
+  /** Standard class typedefs. */
+  typedef BinaryBatchFunctorImageFilter Self;
+  typedef BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
+  Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(BinaryBatchFunctorImageFilter, BinaryFunctorImageFilter);
+
+  typedef typename Superclass::FunctorType           FunctorType;
+  typedef typename Superclass::Input1ImageType       Input1ImageType;
+  typedef typename Superclass::Input2ImageType       Input2ImageType;
+  typedef typename Superclass::OutputImageType       OutputImageType;
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int,
+                      TOutputImage::ImageDimension);
+
+protected:
+  BinaryBatchFunctorImageFilter() {}
+  virtual ~BinaryBatchFunctorImageFilter() {}
+
+  void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                            ThreadIdType threadId) ITK_OVERRIDE;
+
+private:
+  BinaryBatchFunctorImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);                //purposely not implemented
+
+  /** Compute the output region by scanlines when the inputs and the
+   * output are Images, pixel by pixel otherwise */
+  template< typename TInput1Pixel, typename TInput2Pixel, typename TOutputPixel >
+  void DispatchedThreadedGenerateData( const Image< TInput1Pixel, ImageDimension > *input1Ptr,
+                                       const Image< TInput2Pixel, ImageDimension > *input2Ptr,
+                                       Image< TOutputPixel, ImageDimension > *outputPtr,
+                                       const OutputImageRegionType & outputRegionForThread,
+                                       ThreadIdType threadId );
+
+  template< typename TInput1, typename TInput2, typename TOutput >
+  void DispatchedThreadedGenerateData( const TInput1 *,
+                                       const TInput2 *,
+                                       TOutput *,
+                                       const OutputImageRegionType & outputRegionForThread,
+                                       ThreadIdType threadId )
+    {
+      this->Superclass::ThreadedGenerateData( outputRegionForThread, threadId );
+    }
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkBinaryBatchFunctorImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,103 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkBinaryBatchFunctorImageFilter_hxx
+#define itkBinaryBatchFunctorImageFilter_hxx
+
+#include "itkBinaryBatchFunctorImageFilter.h"
+#include "itkImageScanlineIterator.h"
+#include "itkProgressReporter.h"
+
+namespace itk
+{
+/**
+ *
+ */
+template< typename TInputImage1, typename TInputImage2, typename TOutputImage, typename TFunction >
+void
+BinaryBatchFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
+::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                       ThreadIdType threadId)
+{
+  // Null when the input is a constant
+  const TInputImage1 *input1Ptr = dynamic_cast< const TInputImage1 * >( ProcessObject::GetInput(0) );
+  const TInputImage2 *input2Ptr = dynamic_cast< const TInputImage2 * >( ProcessObject::GetInput(1) );
+
+  if ( input1Ptr == ITK_NULLPTR || input2Ptr == ITK_NULLPTR )
+    {
+    this->Superclass::ThreadedGenerateData( outputRegionForThread, threadId );
+    return;
+    }
+
+  this->DispatchedThreadedGenerateData( input1Ptr, input2Ptr, this->GetOutput(), outputRegionForThread, threadId );
+}
+
+/**
+ *
+ */
+template< typename TInputImage1, typename TInputImage2, typename TOutputImage, typename TFunction >
+template< typename TInput1Pixel, typename TInput2Pixel, typename TOutputPixel >
+void
+BinaryBatchFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
+::DispatchedThreadedGenerateData( const Image< TInput1Pixel, ImageDimension > *input1Ptr,
+                                  const Image< TInput2Pixel, ImageDimension > *input2Ptr,
+                                  Image< TOutputPixel, ImageDimension > *outputPtr,
+                                  const OutputImageRegionType & outputRegionForThread,
+                                  ThreadIdType threadId )
+{
+  typedef Image< TOutputPixel, ImageDimension > OutputBufferImageType;
+
+  const SizeValueType size0 = outputRegionForThread.GetSize(0);
+  if ( size0 == 0 )
+    {
+    return;
+    }
+
+  // the lines are read at the output's indices
+  if ( !input1Ptr->GetBufferedRegion().IsInside( outputRegionForThread )
+       || !input2Ptr->GetBufferedRegion().IsInside( outputRegionForThread ) )
+    {
+    itkExceptionMacro( << "The inputs' buffered regions " << input1Ptr->GetBufferedRegion() << " and "
+                       << input2Ptr->GetBufferedRegion() << " do not contain the output region "
+                       << outputRegionForThread );
+    }
+
+  // Support progress methods/callbacks
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() / size0 );
+
+  const FunctorType & functor = this->GetFunctor();
+  const TInput1Pixel *input1Buffer = input1Ptr->GetBufferPointer();
+  const TInput2Pixel *input2Buffer = input2Ptr->GetBufferPointer();
+
+  ImageScanlineIterator< OutputBufferImageType > outIt( outputPtr, outputRegionForThread );
+
+  while ( !outIt.IsAtEnd() )
+    {
+    // The inputs' requested regions are the output region, so the line
+    // is contiguous in the three buffers
+    const typename OutputBufferImageType::IndexType index = outIt.GetIndex();
+    functor.Evaluate( input1Buffer + input1Ptr->ComputeOffset( index ),
+                      input2Buffer + input2Ptr->ComputeOffset( index ),
+                      &outIt.Value(), size0 );
+
+    outIt.NextLine();
+    progress.CompletedPixel(); // potential exception thrown here
+    }
+}
+} // end namespace itk
+
+#endif
@@ -19,6 +19,7 @@
 #define itkBitwiseNotFunctor_h
 
 #include <cmath>
+#include "itkIntTypes.h"
 
 namespace itk
 {
@@ -28,6 +29,13 @@ namespace Functor
  * \class BitwiseNot
  * \brief Performs the C++ unary bitwise NOT operator.
  *
+ * The Evaluate method computes consecutive pixels in a loop without
+ * calls or branches. It is only vectorized when auto-vectorization is
+ * enabled, -O3 with GCC, and with the baseline ISA of the build, SSE2
+ * on x86-64; a conversion between pixel types of different sizes may
+ * keep it scalar. itkBatchFunctorImageFilterBenchmark reports the
+ * speedup over the pixel by pixel filter.
+ *
  * \ingroup SimpleITKFiltersModule
  */
 template< class TInput, class TOutput >
@@ -37,6 +45,9 @@ public:
   // Use default copy, assigned and destructor
   // BitwiseNot() {} default constructor OK
 
+  typedef TInput  InputType;
+  typedef TOutput OutputType;
+
   bool operator!=(const BitwiseNot &) const
     {
       return false;
@@ -51,6 +62,15 @@ public:
     {
       return static_cast<TOutput>( ~A );
     }
+
+  /** Compute count consecutive pixels */
+  void Evaluate( const TInput *input, TOutput *output, SizeValueType count ) const
+    {
+      for ( SizeValueType n = 0; n < count; ++n )
+        {
+        output[n] = static_cast<TOutput>( ~input[n] );
+        }
+    }
 };
 }
 }
@@ -0,0 +1,128 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkComposeFunctor_h
+#define itkComposeFunctor_h
+
+#include "itkIntTypes.h"
+#include "itkMacro.h"
+
+#include <algorithm>
+
+namespace itk
+{
+namespace Functor
+{
+/**
+ * \class Compose
+ * \brief Applies a functor to the result of another.
+ *
+ * The unary functors of this module, such as UnaryMinus,
+ * DivRealByConstant, DivFloorByConstant, BitwiseNot and StaticCast,
+ * and Compose itself, define their InputType and OutputType. The
+ * OutputType of TFirst must be the InputType of TSecond, with a
+ * StaticCast between them to change the type. Longer chains nest
+ * Compose:
+ * \code
+ *   typedef Functor::UnaryMinus< short, short >                  MinusType;
+ *   typedef Functor::DivRealByConstant< short, short, float >    DivideType;
+ *   typedef Functor::StaticCast< float, unsigned char >          CastType;
+ *   typedef Functor::BitwiseNot< unsigned char, unsigned char >  NotType;
+ *   typedef Functor::Compose< Functor::Compose< Functor::Compose< MinusType, DivideType >, CastType >, NotType >
+ *     ChainType;
+ *   typedef UnaryBatchFunctorImageFilter< ShortImageType, MaskImageType, ChainType > FilterType;
+ * \endcode
+ * with the divisor set by
+ * filter->GetFunctor().GetFirst().GetFirst().GetSecond().SetDivisor().
+ *
+ * With UnaryBatchFunctorImageFilter, the whole chain is computed in a
+ * single pass without intermediate images. The Evaluate method applies
+ * the functors to blocks of pixels through a buffer of the
+ * intermediate type small enough to stay in the cache.
+ *
+ * \sa UnaryBatchFunctorImageFilter
+ * \ingroup SimpleITKFiltersModule
+ */
+template< class TFirst, class TSecond >
+class Compose
+{
+public:
+  // Use default copy, assigned and destructor
+  // Compose() {} default constructor OK
+
+  typedef typename TFirst::InputType   InputType;
+  typedef typename TFirst::OutputType  IntermediateType;
+  typedef typename TSecond::OutputType OutputType;
+
+  itkStaticConstMacro(BlockSize, unsigned int, 256);
+
+  bool operator!=(const Compose & other) const
+    {
+      return m_First != other.m_First || m_Second != other.m_Second;
+    }
+
+  bool operator==(const Compose & other) const
+    {
+      return !( *this != other );
+    }
+
+  /** Get the functor applied first */
+  TFirst & GetFirst()
+    {
+      return m_First;
+    }
+  const TFirst & GetFirst() const
+    {
+      return m_First;
+    }
+
+  /** Get the functor applied to the result of the first */
+  TSecond & GetSecond()
+    {
+      return m_Second;
+    }
+  const TSecond & GetSecond() const
+    {
+      return m_Second;
+    }
+
+  inline OutputType operator()(const InputType & A) const
+    {
+      return m_Second( m_First( A ) );
+    }
+
+  /** Compute count consecutive pixels */
+  void Evaluate( const InputType *input, OutputType *output, SizeValueType count ) const
+    {
+      IntermediateType buffer[BlockSize];
+
+      for ( SizeValueType n = 0; n < count; n += BlockSize )
+        {
+        const SizeValueType length = std::min( count - n, static_cast< SizeValueType >( BlockSize ) );
+        m_First.Evaluate( input + n, buffer, length );
+        m_Second.Evaluate( buffer, output + n, length );
+        }
+    }
+
+private:
+  TFirst  m_First;
+  TSecond m_Second;
+};
+}
+}
+
+#endif // itkComposeFunctor_h
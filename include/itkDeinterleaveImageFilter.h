@@ -0,0 +1,150 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkDeinterleaveImageFilter_h
+#define itkDeinterleaveImageFilter_h
+
+#include "itkImageToImageFilter.h"
+
+namespace itk
+{
+/** \class DeinterleaveImageFilter
+ * \brief Splits the interleaved phases of an image into one output
+ * per phase.
+ *
+ * Output k contains the slices k, k+N, k+2N... of the input along
+ * Dimension, where N is the NumberOfPhases, so it has
+ * ceil((size-k)/N) slices for an input of size slices. For example 2
+ * phases separate the even and odd slices, and N phases the frames of
+ * an N phase cine stack. A SliceImageFilter with a start of k and a
+ * step of N has the same slices, but truncates to floor((size-k)/N)
+ * of them, omitting the last slice of the phase when N does not
+ * divide size-k.
+ *
+ * All outputs are computed in one pass over the input, each input
+ * slice is read once and copied to the output of its phase. When an
+ * output is updated, the same region of all the outputs is computed
+ * from a single input requested region, so a streamed input is read
+ * once for all phases.
+ *
+ * The outputs start at index zero. The origin of output k is the
+ * physical location of the input slice k, and the spacing along
+ * Dimension is N times the input's.
+ *
+ * \sa SliceImageFilter
+ *
+ * \ingroup GeometricTransform Streamed
+ * \ingroup SimpleITKFiltersModule
+ */
+template< class TInputImage, class TOutputImage >
+class ITK_EXPORT DeinterleaveImageFilter:
+  public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef DeinterleaveImageFilter                         Self;
+  typedef ImageToImageFilter< TInputImage, TOutputImage > Superclass;
+  typedef SmartPointer< Self >                            Pointer;
+  typedef SmartPointer< const Self >                      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(DeinterleaveImageFilter, ImageToImageFilter);
+
+  /** Typedef to images */
+  typedef TOutputImage                          OutputImageType;
+  typedef TInputImage                           InputImageType;
+  typedef typename OutputImageType::Pointer     OutputImagePointer;
+  typedef typename InputImageType::Pointer      InputImagePointer;
+  typedef typename InputImageType::ConstPointer InputImageConstPointer;
+
+  typedef typename TOutputImage::IndexType        OutputIndexType;
+  typedef typename TInputImage::IndexType         InputIndexType;
+  typedef typename InputIndexType::IndexValueType IndexValueType;
+
+  /** Typedef to describe the output image region type. */
+  typedef typename TOutputImage::RegionType OutputImageRegionType;
+  typedef typename TInputImage::RegionType  InputImageRegionType;
+
+  /** ImageDimension enumeration. */
+  itkStaticConstMacro(ImageDimension, unsigned int,
+                      TInputImage::ImageDimension);
+  itkStaticConstMacro(OutputImageDimension, unsigned int,
+                      TOutputImage::ImageDimension);
+
+  /** Set/Get the number of phases, which is the number of outputs.
+   * The default is 2. */
+  void SetNumberOfPhases( unsigned int numberOfPhases );
+  itkGetConstMacro(NumberOfPhases, unsigned int);
+
+  /** Set/Get the dimension of the interleaved slices. The default is
+   * the last dimension. */
+  itkSetMacro(Dimension, unsigned int);
+  itkGetConstMacro(Dimension, unsigned int);
+
+  /** Get the output of a phase */
+  OutputImageType * GetPhaseOutput( unsigned int phase )
+    {
+      return this->GetOutput( phase );
+    }
+
+  virtual void GenerateOutputInformation() ITK_OVERRIDE;
+
+  virtual void GenerateInputRequestedRegion() ITK_OVERRIDE;
+
+#ifdef ITK_USE_CONCEPT_CHECKING
+  /** Begin concept checking */
+  itkConceptMacro( InputConvertibleToOutputCheck,
+                   ( Concept::Convertible< typename TInputImage::PixelType, typename TOutputImage::PixelType > ) );
+  itkConceptMacro( SameDimensionCheck,
+                   ( Concept::SameDimension< ImageDimension, OutputImageDimension > ) );
+  /** End concept checking */
+#endif
+
+protected:
+  DeinterleaveImageFilter();
+  ~DeinterleaveImageFilter() {}
+  void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  /** The requested region of an output is requested from all the
+   * outputs, cropped to their largest possible region */
+  virtual void GenerateOutputRequestedRegion( DataObject *output ) ITK_OVERRIDE;
+
+  /** The region is a region of the first output, which is the
+   * largest. Each of its lines is copied from the input to the same
+   * line of every output which requests it. */
+  void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                            ThreadIdType threadId) ITK_OVERRIDE;
+
+  void VerifyInputInformation() ITK_OVERRIDE;
+
+private:
+  DeinterleaveImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);          //purposely not implemented
+
+  unsigned int m_NumberOfPhases;
+  unsigned int m_Dimension;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkDeinterleaveImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,317 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkDeinterleaveImageFilter_hxx
+#define itkDeinterleaveImageFilter_hxx
+
+#include "itkDeinterleaveImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageScanlineIterator.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace itk
+{
+/**
+ *
+ */
+template< class TInputImage, class TOutputImage >
+DeinterleaveImageFilter< TInputImage, TOutputImage >
+::DeinterleaveImageFilter() :
+  m_NumberOfPhases( 1 ),
+  m_Dimension( ImageDimension - 1 )
+{
+  this->SetNumberOfPhases( 2 );
+}
+
+/**
+ *
+ */
+template< class TInputImage, class TOutputImage >
+void
+DeinterleaveImageFilter< TInputImage, TOutputImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "NumberOfPhases: " << m_NumberOfPhases << std::endl;
+  os << indent << "Dimension: " << m_Dimension << std::endl;
+}
+
+/**
+ *
+ */
+template< class TInputImage, class TOutputImage >
+void
+DeinterleaveImageFilter< TInputImage, TOutputImage >
+::SetNumberOfPhases( unsigned int numberOfPhases )
+{
+  numberOfPhases = std::max( numberOfPhases, 1u );
+  if ( numberOfPhases == m_NumberOfPhases
+       && this->GetNumberOfIndexedOutputs() == numberOfPhases )
+    {
+    return;
+    }
+
+  m_NumberOfPhases = numberOfPhases;
+
+  // one output per phase, making the missing ones
+  const unsigned int numberOfOutputs = static_cast< unsigned int >( this->GetNumberOfIndexedOutputs() );
+  this->SetNumberOfIndexedOutputs( m_NumberOfPhases );
+  this->SetNumberOfRequiredOutputs( m_NumberOfPhases );
+  for ( unsigned int k = numberOfOutputs; k < m_NumberOfPhases; ++k )
+    {
+    typename DataObject::Pointer output = this->MakeOutput( k );
+    this->SetNthOutput( k, output.GetPointer() );
+    }
+
+  this->Modified();
+}
+
+/**
+ *
+ */
+template< class TInputImage, class TOutputImage >
+void
+DeinterleaveImageFilter< TInputImage, TOutputImage >
+::GenerateOutputInformation()
+{
+  // Call the superclass' implementation of this method, which copies
+  // the input's information to all the outputs
+  Superclass::GenerateOutputInformation();
+
+  InputImageConstPointer inputPtr  = this->GetInput();
+
+  const typename TInputImage::SpacingType &inputSpacing = inputPtr->GetSpacing();
+  const typename TInputImage::SizeType &inputSize = inputPtr->GetLargestPossibleRegion().GetSize();
+  const typename TInputImage::IndexType &inputIndex = inputPtr->GetLargestPossibleRegion().GetIndex();
+
+  typename TOutputImage::SpacingType outputSpacing = inputSpacing;
+  outputSpacing[m_Dimension] *= m_NumberOfPhases;
+
+  typename TOutputImage::IndexType outputStartIndex;
+  outputStartIndex.Fill(0);
+
+  for ( unsigned int k = 0; k < m_NumberOfPhases; ++k )
+    {
+    OutputImageType *outputPtr = this->GetOutput( k );
+
+    typename TOutputImage::SizeType outputSize = inputSize;
+    outputSize[m_Dimension] = ( inputSize[m_Dimension] > k )
+      ? ( inputSize[m_Dimension] - k + m_NumberOfPhases - 1 ) / m_NumberOfPhases : 0u;
+
+    // the origin is the location of the first slice of the phase
+    typename TInputImage::IndexType phaseStartIndex = inputIndex;
+    phaseStartIndex[m_Dimension] += k;
+
+    typename TOutputImage::PointType outputOrigin;
+    inputPtr->TransformIndexToPhysicalPoint( phaseStartIndex, outputOrigin );
+
+    outputPtr->SetSpacing( outputSpacing );
+    outputPtr->SetOrigin( outputOrigin );
+
+    OutputImageRegionType outputLargestPossibleRegion;
+    outputLargestPossibleRegion.SetSize( outputSize );
+    outputLargestPossibleRegion.SetIndex( outputStartIndex );
+
+    outputPtr->SetLargestPossibleRegion( outputLargestPossibleRegion );
+    }
+}
+
+/**
+ *
+ */
+template< class TInputImage, class TOutputImage >
+void
+DeinterleaveImageFilter< TInputImage, TOutputImage >
+::GenerateOutputRequestedRegion( DataObject *output )
+{
+  const OutputImageType *requestingPtr = dynamic_cast< const OutputImageType * >( output );
+  if ( !requestingPtr )
+    {
+    itkExceptionMacro( "The requesting output is not of the output image type" );
+    }
+
+  const OutputImageRegionType requestedRegion = requestingPtr->GetRequestedRegion();
+
+  for ( unsigned int k = 0; k < m_NumberOfPhases; ++k )
+    {
+    OutputImageType *outputPtr = this->GetOutput( k );
+    if ( outputPtr == requestingPtr )
+      {
+      continue;
+      }
+
+    // the last phases may have one slice less than the requesting
+    // output
+    OutputImageRegionType region = requestedRegion;
+    if ( !region.Crop( outputPtr->GetLargestPossibleRegion() ) )
+      {
+      region.SetIndex( outputPtr->GetLargestPossibleRegion().GetIndex() );
+      region.SetSize( m_Dimension, 0 );
+      }
+    outputPtr->SetRequestedRegion( region );
+    }
+}
+
+/**
+ *
+ */
+template< class TInputImage, class TOutputImage >
+void
+DeinterleaveImageFilter< TInputImage, TOutputImage >
+::GenerateInputRequestedRegion()
+{
+  InputImagePointer inputPtr = const_cast< TInputImage * >( this->GetInput() );
+  if ( !inputPtr )
+    {
+    return;
+    }
+
+  // The first phase has the most slices, its requested region covers
+  // the requested regions of all the phases
+  const OutputImageRegionType &outputRequestedRegion = this->GetOutput( 0 )->GetRequestedRegion();
+
+  const typename TInputImage::IndexType &inputIndex = inputPtr->GetLargestPossibleRegion().GetIndex();
+
+  InputImageRegionType inputRequestedRegion;
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+    inputRequestedRegion.SetIndex( i, inputIndex[i] + outputRequestedRegion.GetIndex(i) );
+    inputRequestedRegion.SetSize( i, outputRequestedRegion.GetSize(i) );
+    }
+  inputRequestedRegion.SetIndex( m_Dimension, inputIndex[m_Dimension]
+                                 + outputRequestedRegion.GetIndex(m_Dimension) * static_cast< IndexValueType >( m_NumberOfPhases ) );
+  inputRequestedRegion.SetSize( m_Dimension, outputRequestedRegion.GetSize(m_Dimension) * m_NumberOfPhases );
+
+  // the last slab may be incomplete
+  if ( inputRequestedRegion.GetNumberOfPixels() > 0 )
+    {
+    inputRequestedRegion.Crop( inputPtr->GetLargestPossibleRegion() );
+    }
+
+  inputPtr->SetRequestedRegion( inputRequestedRegion );
+}
+
+/**
+ *
+ */
+template< class TInputImage, class TOutputImage >
+void
+DeinterleaveImageFilter< TInputImage, TOutputImage >
+::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                       ThreadIdType threadId)
+{
+  InputImageConstPointer inputPtr = this->GetInput();
+
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+
+  const typename TInputImage::IndexType &inputIndex = inputPtr->GetLargestPossibleRegion().GetIndex();
+
+  // along the first dimension the pixels of a phase are strided
+  const unsigned int inputStep = ( m_Dimension == 0 ) ? m_NumberOfPhases : 1;
+
+  // the part of the thread's region requested from each phase
+  std::vector< OutputImageRegionType > phaseRegions( m_NumberOfPhases );
+  std::vector< bool >                  phaseRequested( m_NumberOfPhases );
+  for ( unsigned int k = 0; k < m_NumberOfPhases; ++k )
+    {
+    phaseRegions[k] = outputRegionForThread;
+    phaseRequested[k] = phaseRegions[k].Crop( this->GetOutput( k )->GetRequestedRegion() )
+      && phaseRegions[k].GetNumberOfPixels() > 0;
+    }
+
+  // Walk the lines of the thread's region, each line is copied to all
+  // the phases so the input slab of the line is read once
+  ImageScanlineIterator< TOutputImage > lineIt( this->GetOutput( 0 ), outputRegionForThread );
+
+  while ( !lineIt.IsAtEnd() )
+    {
+    OutputImageRegionType lineRegion = outputRegionForThread;
+    lineRegion.SetIndex( lineIt.GetIndex() );
+    for ( unsigned int i = 1; i < ImageDimension; ++i )
+      {
+      lineRegion.SetSize( i, 1 );
+      }
+
+    for ( unsigned int k = 0; k < m_NumberOfPhases; ++k )
+      {
+      OutputImageRegionType phaseLineRegion = lineRegion;
+      if ( !phaseRequested[k] || !phaseLineRegion.Crop( phaseRegions[k] ) )
+        {
+        continue;
+        }
+
+      const SizeValueType ln = phaseLineRegion.GetSize(0);
+
+      InputImageRegionType inputLineRegion;
+      for ( unsigned int i = 0; i < ImageDimension; ++i )
+        {
+        inputLineRegion.SetIndex( i, inputIndex[i] + phaseLineRegion.GetIndex(i) );
+        inputLineRegion.SetSize( i, 1 );
+        }
+      inputLineRegion.SetIndex( m_Dimension, inputIndex[m_Dimension]
+                                + phaseLineRegion.GetIndex(m_Dimension) * static_cast< IndexValueType >( m_NumberOfPhases ) + k );
+      inputLineRegion.SetSize( 0, ( ln - 1 ) * inputStep + 1 );
+
+      ImageRegionConstIterator< TInputImage > inIt( inputPtr, inputLineRegion );
+      ImageRegionIterator< TOutputImage >     outIt( this->GetOutput( k ), phaseLineRegion );
+
+      for ( SizeValueType x = 0; x < ln; ++x )
+        {
+        if ( x > 0 )
+          {
+          for ( unsigned int s = 0; s < inputStep; ++s )
+            {
+            ++inIt;
+            }
+          }
+        outIt.Set( static_cast< typename TOutputImage::PixelType >( inIt.Get() ) );
+        ++outIt;
+        }
+      }
+
+    for ( SizeValueType x = 0; x < outputRegionForThread.GetSize(0); ++x )
+      {
+      progress.CompletedPixel();
+      }
+    lineIt.NextLine();
+    }
+}
+
+/**
+ *
+ */
+template< class TInputImage, class TOutputImage >
+void
+DeinterleaveImageFilter< TInputImage, TOutputImage >
+::VerifyInputInformation()
+{
+  Superclass::VerifyInputInformation();
+
+  if ( m_Dimension >= ImageDimension )
+    {
+    itkExceptionMacro( "Dimension " << m_Dimension << " is not lower than the image dimension " << ImageDimension );
+    }
+}
+
+} // end namespace itk
+
+#endif
@@ -30,6 +30,13 @@ namespace Functor
  *
  * The result is then static_cast'ed to the output pixel type.
  *
+ * The Evaluate method computes consecutive pixels without a branch on
+ * the divisor. Whether the compiler vectorizes the loop depends on the
+ * pixel types: with the baseline ISA of the build, SSE2 on x86-64,
+ * the conversions of 64 bit integers are scalar.
+ * itkBatchFunctorImageFilterBenchmark reports the speedup over the
+ * pixel by pixel filter.
+ *
  * \ingroup SimpleITKFiltersModule
  */
 template< class TInput1, class TInput2, class TOutput >
@@ -60,6 +67,128 @@ public:
       return NumericTraits< TOutput >::max( static_cast<TOutput>(A) );
       }
   }
+
+  /** Compute count consecutive pixels */
+  void Evaluate( const TInput1 *input1, const TInput2 *input2, TOutput *output, SizeValueType count ) const
+  {
+    typedef typename NumericTraits<TInput1>::RealType RealType1;
+    typedef typename NumericTraits<TInput2>::RealType RealType2;
+
+    for ( SizeValueType n = 0; n < count; ++n )
+      {
+      // divide by one where the divisor is zero and select the result
+      const bool      valid = ( input2[n] != (TInput2)0 );
+      const RealType2 b = valid ? static_cast<RealType2>( input2[n] ) : NumericTraits<RealType2>::OneValue();
+      const TOutput   q = static_cast<TOutput>( static_cast<RealType1>( input1[n] ) / b );
+      output[n] = valid ? q : NumericTraits< TOutput >::max( static_cast<TOutput>( input1[n] ) );
+      }
+  }
+};
+
+/**
+ * \class DivRealByConstant
+ * \brief Promotes the argument to real type and multiplies by the
+ * reciprocal of a constant divisor.
+ *
+ * The reciprocal is computed once by SetDivisor. The product may
+ * differ from the quotient of DivReal by one unit in the last place
+ * of the real type. As this error changes the truncation of exact
+ * quotients, 49 * (1/49) is below 1, an integer TOutput is computed
+ * by the division of DivReal instead.
+ *
+ * If the divisor is 0 then NumericTraits<TOutput>::max is returned.
+ *
+ * \sa DivReal
+ * \ingroup SimpleITKFiltersModule
+ */
+template< class TInput1, class TInput2, class TOutput >
+class DivRealByConstant
+{
+public:
+  typedef TInput1                                   InputType;
+  typedef TOutput                                   OutputType;
+  typedef typename NumericTraits<TInput1>::RealType RealType1;
+  typedef typename NumericTraits<TInput2>::RealType RealType2;
+
+  DivRealByConstant() :
+    m_Divisor( 1 ),
+    m_RealDivisor( 1 ),
+    m_Reciprocal( 1 ),
+    m_Valid( true )
+  {}
+
+  bool operator!=(const DivRealByConstant & other) const
+  {
+    return m_Divisor != other.m_Divisor;
+  }
+
+  bool operator==(const DivRealByConstant & other) const
+  {
+    return !( *this != other );
+  }
+
+  /** Set the divisor, and compute its reciprocal */
+  void SetDivisor( const TInput2 & divisor )
+  {
+    m_Divisor = divisor;
+    m_Valid = ( divisor != (TInput2)0 );
+    if ( m_Valid )
+      {
+      m_RealDivisor = static_cast<RealType2>( divisor );
+      m_Reciprocal = NumericTraits<RealType2>::OneValue() / m_RealDivisor;
+      }
+  }
+
+  const TInput2 & GetDivisor() const
+  {
+    return m_Divisor;
+  }
+
+  inline TOutput operator()(const TInput1 & A) const
+  {
+    if ( !m_Valid )
+      {
+      return NumericTraits< TOutput >::max( static_cast<TOutput>(A) );
+      }
+    if ( NumericTraits<TOutput>::is_integer )
+      {
+      return static_cast<TOutput>( static_cast<RealType1>(A) / m_RealDivisor );
+      }
+    return static_cast<TOutput>( static_cast<RealType1>(A) * m_Reciprocal );
+  }
+
+  /** Compute count consecutive pixels */
+  void Evaluate( const TInput1 *input, TOutput *output, SizeValueType count ) const
+  {
+    if ( !m_Valid )
+      {
+      for ( SizeValueType n = 0; n < count; ++n )
+        {
+        output[n] = NumericTraits< TOutput >::max( static_cast<TOutput>( input[n] ) );
+        }
+      return;
+      }
+
+    if ( NumericTraits<TOutput>::is_integer )
+      {
+      for ( SizeValueType n = 0; n < count; ++n )
+        {
+        output[n] = static_cast<TOutput>( static_cast<RealType1>( input[n] ) / m_RealDivisor );
+        }
+      return;
+      }
+
+    for ( SizeValueType n = 0; n < count; ++n )
+      {
+      output[n] = static_cast<TOutput>( static_cast<RealType1>( input[n] ) * m_Reciprocal );
+      }
+  }
+
+private:
+  TInput2   m_Divisor;
+  RealType2 m_RealDivisor;
+  RealType2 m_Reciprocal;
+  bool      m_Valid;
 };
 }
 }
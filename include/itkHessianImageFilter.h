@@ -20,17 +20,91 @@
 
 #include "itkImage.h"
 #include "itkImageToImageFilter.h"
+#include "itkNeighborhoodAlgorithm.h"
 #include "itkSymmetricSecondRankTensor.h"
+#include "itkMultiThreader.h"
+#include "itkProgressReporter.h"
+
+#include <vector>
 
 namespace itk
 {
 
+/**
+ * \class HessianOutputImage
+ * \brief Defines an output image type for HessianImageFilter with the
+ * given tensor component type.
+ *
+ * The default output of HessianImageFilter has the RealType of the
+ * input pixel as component, which is double for integer and float
+ * pixels. Using float components halves the memory and the bandwidth
+ * of the output, while the derivatives are still computed with the
+ * RealType:
+ *
+ * \code
+ * typedef HessianImageFilter< ImageType, HessianOutputImage< ImageType >::Type > HessianFilterType;
+ * \endcode
+ *
+ * \ingroup SimpleITKFiltersModule
+ */
+template< typename TInputImage, typename TComponent = float >
+struct HessianOutputImage
+{
+  typedef Image< SymmetricSecondRankTensor< TComponent, TInputImage::ImageDimension >,
+                 TInputImage::ImageDimension > Type;
+};
+
+/**
+ * \class HessianEigenValuesOutputImage
+ * \brief Defines an output image type for HessianImageFilter which
+ * produces the eigenvalues of the Hessian instead of the tensor.
+ *
+ * \code
+ * typedef HessianImageFilter< ImageType, HessianEigenValuesOutputImage< ImageType >::Type > HessianFilterType;
+ * \endcode
+ *
+ * \ingroup SimpleITKFiltersModule
+ */
+template< typename TInputImage, typename TComponent = float >
+struct HessianEigenValuesOutputImage
+{
+  typedef Image< FixedArray< TComponent, TInputImage::ImageDimension >,
+                 TInputImage::ImageDimension > Type;
+};
+
 /**
  * \class HessianImageFilter
  * \brief Computes the Hessian matrix of an image by central differences
  *
- * This filter directly computes the derivatives of an image for
- * the Hessian and does not convolve with a Gaussian kernel.
+ * By default this filter directly computes the derivatives of an
+ * image for the Hessian and does not convolve with a Gaussian
+ * kernel. When Sigma is greater than zero, the input is smoothed
+ * with a separable Gaussian kernel before the central differences
+ * are computed. The smoothing is fused with the Hessian computation
+ * and is performed slice by slice along the last dimension, so that
+ * only a few smoothed slices are buffered per thread instead of a
+ * full smoothed image.
+ *
+ * The derivatives and the smoothing are computed with TRealType,
+ * by default the RealType of the input pixel, and are cast to the
+ * component type of the output tensor, see HessianOutputImage for a
+ * reduced precision output. A float TRealType also halves the
+ * bandwidth of the smoothed slices of integer and double inputs.
+ *
+ * If the output pixel type is a FixedArray with the length of the
+ * image dimension instead of a SymmetricSecondRankTensor, the
+ * eigenvalues of the Hessian are computed in the same pass, and only
+ * the eigenvalues sorted in ascending order are written to the
+ * output. The tensor image is then never allocated, see
+ * HessianEigenValuesOutputImage.
+ *
+ * EvaluateAtIndices and EvaluateAtMask compute the output at a sparse
+ * set of pixels without running the filter over the whole image.
+ *
+ * The pixels whose neighborhood is completely inside the input's
+ * buffer are computed along scanlines directly from the input
+ * buffer, only the boundary faces use a neighborhood iterator with
+ * a boundary condition.
  *
  * \sa HessianRecursiveGaussianImageFilter
  * \sa SmoothingRecursiveGaussianImageFilter
@@ -42,7 +116,8 @@ template <typename TInputImage,
           typename TOutputImage = Image< SymmetricSecondRankTensor<
                                            typename NumericTraits< typename TInputImage::PixelType >::RealType,
                                            TInputImage::ImageDimension >,
-                                         TInputImage::ImageDimension > >
+                                         TInputImage::ImageDimension >,
+          typename TRealType = typename NumericTraits< typename TInputImage::PixelType >::RealType >
 class HessianImageFilter :
     public ImageToImageFilter< TInputImage, TOutputImage>
 {
@@ -58,6 +133,9 @@ public:
   /** Pixel Type of the input image */
   typedef TInputImage                        InputImageType;
   typedef typename InputImageType::PixelType PixelType;
+  typedef TRealType                          RealType;
+  typedef typename InputImageType::IndexType  IndexType;
+  typedef typename InputImageType::RegionType InputImageRegionType;
 
   /** Type of the output Image */
   typedef TOutputImage                                 OutputImageType;
@@ -71,8 +149,43 @@ public:
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
 
+  /** Set/Get the standard deviation of the Gaussian smoothing in
+   * physical units. The default 0 disables smoothing. The kernel is
+   * truncated at 4 sigma. */
+  itkSetClampMacro(Sigma, double, 0.0, NumericTraits<double>::max());
+  itkGetConstMacro(Sigma, double);
+
+  /** Set/Get the number of bytes of the input a tile of the interior
+   * may read. When the three slices around a slice of a 3D region
+   * exceed this size, the region is computed by tiles in the first two
+   * dimensions so the slices are reused from the cache. The default is
+   * 256KB, 0 disables the tiling. */
+  itkSetMacro(CacheBlockSize, SizeValueType);
+  itkGetConstMacro(CacheBlockSize, SizeValueType);
+
   virtual void GenerateInputRequestedRegion() ITK_OVERRIDE;
 
+  typedef std::vector< IndexType >       IndexListType;
+  typedef std::vector< OutputPixelType > OutputPixelListType;
+
+  /** Evaluate the output pixels at a list of indices of the input.
+   *
+   * The input is not updated, it must be up to date and its buffered
+   * region must contain the neighborhoods of the indices, otherwise
+   * an exception is thrown. Only the neighborhoods are read, and the
+   * indices are evaluated in parallel by a threader of their own, so
+   * the cost scales with the number of indices rather than with the
+   * size of the image. The values are the same as the output of the
+   * filter at the indices, including the Sigma smoothing and the
+   * eigenvalue output. */
+  void EvaluateAtIndices( const IndexListType &indices, OutputPixelListType &values );
+
+  /** Evaluate the output pixels at the non-zero pixels of a mask with
+   * the same grid as the input. The indices of the non-zero pixels are
+   * returned in the order of the mask's buffer. */
+  template< typename TMaskImage >
+  void EvaluateAtMask( const TMaskImage *mask, IndexListType &indices, OutputPixelListType &values );
+
 
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
@@ -87,13 +200,267 @@ protected:
 
   HessianImageFilter( void );
 
+  void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
   void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId) ITK_OVERRIDE;
 
+  /** Compute the Hessian over the output region.
+   *
+   * The tensors are passed to the writer by scanline, the writer
+   * provides the TensorType the Hessian is computed as, and the
+   * methods:
+   * TensorType *BeginScanline(OutputPixelType *out, SizeValueType length);
+   * void EndScanline(OutputPixelType *out, SizeValueType length);
+   * where out is the output of the scanline. The tensors must be
+   * computed into the returned buffer before EndScanline is called. */
+  template< typename TWriter >
+  void ThreadedComputeHessian(const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId, TWriter &writer);
+
+  typedef Image< RealType, TInputImage::ImageDimension > RealImageType;
+
+  typedef typename NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< TInputImage >::FaceListType FaceListType;
+
+  /** The boundary faces of a thread's region and the buffers of the
+   * smoothed slices, reused by ComputeHessianRegion for the parts of
+   * the region */
+  struct ThreadBuffers
+  {
+    FaceListType                    Faces;
+    typename RealImageType::Pointer SliceBuffer;
+    typename RealImageType::Pointer Temp1;
+    typename RealImageType::Pointer Temp2;
+  };
+
+  /** Compute the boundary faces of the thread's region and create the
+   * buffers, which grow to the largest part computed */
+  void InitializeThreadBuffers( const OutputImageRegionType &region, ThreadBuffers &buffers ) const;
+
+  /** Compute the Hessian over a region, reporting its pixels to the
+   * progress of the calling thread, for filters computing the Hessian
+   * into their own output */
+  template< typename TWriter >
+  void ComputeHessianRegion(const OutputImageRegionType& region, TWriter &writer, ProgressReporter &progress);
+
+  /** Compute the Hessian over a part of the region the buffers were
+   * initialized for, for filters computing several parts per thread */
+  template< typename TWriter >
+  void ComputeHessianRegion(const OutputImageRegionType& region, TWriter &writer, ProgressReporter &progress,
+                            ThreadBuffers &buffers);
+
+  /** Compute the Hessian at count indices for the writer, which
+   * receives scanlines of length 1 */
+  template< typename TWriter >
+  void ThreadedComputeHessianAtIndices( const IndexType *indices, OutputPixelType *values, SizeValueType count, TWriter &writer );
+
+  /** Evaluate a part of the indices of EvaluateAtIndices in a thread.
+   *
+   * Derived classes with an output pixel other than a tensor or
+   * eigenvalues override this method and ThreadedGenerateData, and
+   * call ThreadedComputeHessianAtIndices and ThreadedComputeHessian
+   * with their own writer. */
+  virtual void ThreadedEvaluateAtIndices( const IndexType *indices, OutputPixelType *values, SizeValueType count );
+
+  /** Compute the region when Sigma is greater than zero */
+  template< typename TWriter >
+  void ComputeHessianRegionWithSmoothing(const OutputImageRegionType& region, TWriter &writer, ProgressReporter &progress,
+                                         ThreadBuffers &buffers);
+
+  /** Set the Sigma of the next computation without modifying the
+   * filter, for derived classes computing several scales in one
+   * update */
+  void SetSigmaForScale( double sigma )
+    {
+      m_Sigma = sigma;
+    }
+
+  /** Split a region into tiles whose three slices fit in the
+   * CacheBlockSize */
+  void SplitIntoTiles( const OutputImageRegionType &region, std::vector< OutputImageRegionType > &tiles ) const;
+
+  /** Number of pixels in each direction of the smoothing kernel */
+  typename InputImageType::SizeType GetSmoothingRadius( void ) const;
+
+  /** Compute the scale factors of the central differences from the
+   * input's spacing, as used by ComputeHessianScanline. */
+  void ComputeDifferenceScales( RealType *diagonalScale, RealType *crossScale ) const;
+
+  /** Compute the Hessian of length consecutive pixels from a buffer,
+   * without boundary checks. The stride is the offset to the next
+   * pixel in each dimension, diagonalScale is 1/(spacing[i]^2) and
+   * crossScale is 1/(4*spacing[i]*spacing[j]) for i<j in the order of
+   * the tensor's components. */
+  template< typename TValue, typename TTensor >
+  static void ComputeHessianScanline( const TValue *in,
+                                      TTensor *out,
+                                      SizeValueType length,
+                                      const OffsetValueType *stride,
+                                      const RealType *diagonalScale,
+                                      const RealType *crossScale );
+
+  /** Select the unrolled 2D and 3D stencils of ComputeHessianScanline
+   * at compile time, DispatchBase is the N-D version */
+  struct DispatchBase {};
+  template< unsigned int VDimension >
+  struct Dispatch : public DispatchBase {};
+
+  template< typename TValue, typename TTensor >
+  static void ComputeHessianScanline( const TValue *in,
+                                      TTensor *out,
+                                      SizeValueType length,
+                                      const OffsetValueType *stride,
+                                      const RealType *diagonalScale,
+                                      const RealType *crossScale,
+                                      const DispatchBase & );
+
+  template< typename TValue, typename TTensor >
+  static void ComputeHessianScanline( const TValue *in,
+                                      TTensor *out,
+                                      SizeValueType length,
+                                      const OffsetValueType *stride,
+                                      const RealType *diagonalScale,
+                                      const RealType *crossScale,
+                                      const Dispatch<2> & );
+
+  template< typename TValue, typename TTensor >
+  static void ComputeHessianScanline( const TValue *in,
+                                      TTensor *out,
+                                      SizeValueType length,
+                                      const OffsetValueType *stride,
+                                      const RealType *diagonalScale,
+                                      const RealType *crossScale,
+                                      const Dispatch<3> & );
+
 private:
 
   HessianImageFilter(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemented
 
+  /** Compute m_GaussianKernels from Sigma and the input's spacing */
+  void InitializeGaussianKernels( void );
+
+  struct EvaluateThreadStruct
+  {
+    Self            *Filter;
+    const IndexType *Indices;
+    OutputPixelType *Values;
+    SizeValueType    NumberOfIndices;
+  };
+
+  static ITK_THREAD_RETURN_TYPE EvaluateThreaderCallback( void *arg );
+
+  /** Writes the computed tensors directly into the output */
+  class TensorScanlineWriter
+  {
+  public:
+    typedef OutputPixelType TensorType;
+
+    TensorType *BeginScanline( OutputPixelType *out, SizeValueType )
+      {
+      return out;
+      }
+
+    void EndScanline( OutputPixelType *, SizeValueType ) {}
+  };
+
+  /** Computes the tensors of a scanline into a buffer, and writes
+   * their eigenvalues into the output */
+  class EigenValuesScanlineWriter
+  {
+  public:
+    typedef SymmetricSecondRankTensor< RealType, TInputImage::ImageDimension > TensorType;
+
+    TensorType *BeginScanline( OutputPixelType *, SizeValueType length )
+      {
+      if ( m_Buffer.size() < length )
+        {
+        m_Buffer.resize( length );
+        }
+      return &m_Buffer[0];
+      }
+
+    void EndScanline( OutputPixelType *out, SizeValueType length )
+      {
+      typedef typename OutputPixelType::ValueType OutputComponentType;
+
+      typename TensorType::EigenValuesArrayType eigenValues;
+      for ( SizeValueType x = 0; x < length; ++x )
+        {
+        m_Buffer[x].ComputeEigenValues( eigenValues );
+        for ( unsigned int i = 0; i < TInputImage::ImageDimension; ++i )
+          {
+          out[x][i] = static_cast< OutputComponentType >( eigenValues[i] );
+          }
+        }
+      }
+
+  private:
+    std::vector< TensorType > m_Buffer;
+  };
+
+  /** Select the writer from the output pixel type */
+  template< typename TComponent >
+  void DispatchedThreadedGenerateData( const OutputImageRegionType& outputRegionForThread,
+                                       ThreadIdType threadId,
+                                       const SymmetricSecondRankTensor< TComponent, TInputImage::ImageDimension > * )
+    {
+      TensorScanlineWriter writer;
+      this->ThreadedComputeHessian( outputRegionForThread, threadId, writer );
+    }
+
+  template< typename TComponent >
+  void DispatchedThreadedGenerateData( const OutputImageRegionType& outputRegionForThread,
+                                       ThreadIdType threadId,
+                                       const FixedArray< TComponent, TInputImage::ImageDimension > * )
+    {
+      EigenValuesScanlineWriter writer;
+      this->ThreadedComputeHessian( outputRegionForThread, threadId, writer );
+    }
+
+  template< typename TComponent >
+  void DispatchedEvaluateAtIndices( const IndexType *indices, OutputPixelType *values, SizeValueType count,
+                                    const SymmetricSecondRankTensor< TComponent, TInputImage::ImageDimension > * )
+    {
+      TensorScanlineWriter writer;
+      this->ThreadedComputeHessianAtIndices( indices, values, count, writer );
+    }
+
+  template< typename TComponent >
+  void DispatchedEvaluateAtIndices( const IndexType *indices, OutputPixelType *values, SizeValueType count,
+                                    const FixedArray< TComponent, TInputImage::ImageDimension > * )
+    {
+      EigenValuesScanlineWriter writer;
+      this->ThreadedComputeHessianAtIndices( indices, values, count, writer );
+    }
+
+  /** Other output pixels require a derived class with a writer */
+  template< typename TPixel >
+  void DispatchedThreadedGenerateData( const OutputImageRegionType&, ThreadIdType, const TPixel * )
+    {
+      itkExceptionMacro( << "The output pixel type is not a SymmetricSecondRankTensor or a FixedArray of eigenvalues" );
+    }
+
+  template< typename TPixel >
+  void DispatchedEvaluateAtIndices( const IndexType *, OutputPixelType *, SizeValueType, const TPixel * )
+    {
+      itkExceptionMacro( << "The output pixel type is not a SymmetricSecondRankTensor or a FixedArray of eigenvalues" );
+    }
+
+  /** Smooth the slice of the input at the index along the last
+   * dimension, and write it into the slot of the buffer of three
+   * slices. */
+  void SmoothSlice( IndexValueType slice,
+                    unsigned int slot,
+                    RealImageType *sliceBuffer,
+                    RealImageType *temp1,
+                    RealImageType *temp2 );
+
+  double        m_Sigma;
+  SizeValueType m_CacheBlockSize;
+
+  std::vector< std::vector< RealType > > m_GaussianKernels;
+
 };
 
 } // end namespace itk
@@ -22,11 +22,15 @@
 #include "itkHessianImageFilter.h"
 
 #include "itkImageRegionConstIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkImageRegionIterator.h"
-#include "itkNeighborhoodAlgorithm.h"
+#include "itkImageScanlineIterator.h"
 
 #include "itkProgressReporter.h"
 #include "itkProgressAccumulator.h"
+#include "itkMath.h"
+
+#include <algorithm>
 
 namespace itk
 {
@@ -35,18 +39,51 @@ namespace itk
  *  Constructor
  */
 
-template <typename TInputImage, typename TOutputImage >
-HessianImageFilter<TInputImage,TOutputImage>
+template <typename TInputImage, typename TOutputImage, typename TRealType >
+HessianImageFilter<TInputImage,TOutputImage,TRealType>
 ::HessianImageFilter( void )
+  : m_Sigma( 0.0 ),
+    m_CacheBlockSize( 256*1024 )
 {
 }
 
+template <typename TInputImage, typename TOutputImage, typename TRealType >
+void
+HessianImageFilter<TInputImage,TOutputImage,TRealType>
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Sigma: " << m_Sigma << std::endl;
+  os << indent << "CacheBlockSize: " << m_CacheBlockSize << std::endl;
+}
+
+template <typename TInputImage, typename TOutputImage, typename TRealType >
+typename HessianImageFilter<TInputImage,TOutputImage,TRealType>::InputImageType::SizeType
+HessianImageFilter<TInputImage,TOutputImage,TRealType>
+::GetSmoothingRadius( void ) const
+{
+  typename InputImageType::SizeType radius;
+  radius.Fill( 0 );
+
+  const InputImageType *input = this->GetInput();
+  if ( m_Sigma > 0.0 && input )
+    {
+    const typename InputImageType::SpacingType &spacing = input->GetSpacing();
+    for ( unsigned int i = 0; i < TInputImage::ImageDimension; ++i )
+      {
+      radius[i] = Math::Ceil<SizeValueType>( 4.0 * m_Sigma / spacing[i] );
+      }
+    }
+  return radius;
+}
+
 /**
  * Enlarge Input Requested Region
  */
-template< class TInputImage, class TOutputImage >
+template< class TInputImage, class TOutputImage, class TRealType >
 void
-HessianImageFilter< TInputImage, TOutputImage >
+HessianImageFilter< TInputImage, TOutputImage, TRealType >
 ::GenerateInputRequestedRegion()
 {
   // call the superclass' implementation of this method. this should
@@ -63,8 +100,13 @@ HessianImageFilter< TInputImage, TOutputImage >
     }
 
 
-  // the hessaion just needs a 1 radius neighborhood
-  const unsigned int radius = 1;
+  // the hessaion just needs a 1 radius neighborhood, in addition to
+  // the radius of the smoothing kernel
+  typename TInputImage::SizeType radius = this->GetSmoothingRadius();
+  for ( unsigned int i = 0; i < TInputImage::ImageDimension; ++i )
+    {
+    radius[i] += 1;
+    }
 
   // get a copy of the input requested region (should equal the output
   // requested region)
@@ -97,17 +139,352 @@ HessianImageFilter< TInputImage, TOutputImage >
     }
 }
 
+/**
+ * Compute the smoothing kernels
+ */
+template <typename TInputImage, typename TOutputImage, typename TRealType >
+void
+HessianImageFilter<TInputImage,TOutputImage,TRealType>
+::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  this->InitializeGaussianKernels();
+}
+
+/**
+ * Sampled Gaussian kernels of each dimension
+ */
+template <typename TInputImage, typename TOutputImage, typename TRealType >
+void
+HessianImageFilter<TInputImage,TOutputImage,TRealType>
+::InitializeGaussianKernels()
+{
+  m_GaussianKernels.clear();
+
+  if ( m_Sigma > 0.0 )
+    {
+    const typename InputImageType::SizeType radius = this->GetSmoothingRadius();
+    const typename InputImageType::SpacingType &spacing = this->GetInput()->GetSpacing();
+
+    m_GaussianKernels.resize( TInputImage::ImageDimension );
+    for ( unsigned int i = 0; i < TInputImage::ImageDimension; ++i )
+      {
+      std::vector< RealType > &kernel = m_GaussianKernels[i];
+      const IndexValueType     r = static_cast< IndexValueType >( radius[i] );
+
+      kernel.resize( 2*radius[i] + 1 );
+
+      RealType sum = 0.0;
+      for ( IndexValueType k = -r; k <= r; ++k )
+        {
+        const double x = k * spacing[i] / m_Sigma;
+        kernel[k+r] = std::exp( -0.5 * x * x );
+        sum += kernel[k+r];
+        }
+      for ( size_t k = 0; k < kernel.size(); ++k )
+        {
+        kernel[k] /= sum;
+        }
+      }
+    }
+}
+
+/**
+ * Scale factors for the central differences
+ */
+template <typename TInputImage, typename TOutputImage, typename TRealType >
+void
+HessianImageFilter<TInputImage,TOutputImage,TRealType>
+::ComputeDifferenceScales( RealType *diagonalScale, RealType *crossScale ) const
+{
+  const typename TInputImage::SpacingType &spacing = this->GetInput()->GetSpacing();
+
+  unsigned int m = 0;
+  for ( unsigned int i = 0; i < TInputImage::ImageDimension; ++i )
+    {
+    diagonalScale[i] = 1.0 / ( spacing[i] * spacing[i] );
+    for ( unsigned int j = i + 1; j < TInputImage::ImageDimension; ++j )
+      {
+      crossScale[m++] = 1.0 / ( 4.0 * spacing[i] * spacing[j] );
+      }
+    }
+}
+
+/**
+ * Scanline computation
+ */
+template <typename TInputImage, typename TOutputImage, typename TRealType >
+template< typename TValue, typename TTensor >
+void
+HessianImageFilter<TInputImage,TOutputImage,TRealType>
+::ComputeHessianScanline( const TValue *in,
+                          TTensor *out,
+                          SizeValueType length,
+                          const OffsetValueType *stride,
+                          const RealType *diagonalScale,
+                          const RealType *crossScale )
+{
+  ComputeHessianScanline( in, out, length, stride, diagonalScale, crossScale,
+                          Dispatch< TInputImage::ImageDimension >() );
+}
+
+template <typename TInputImage, typename TOutputImage, typename TRealType >
+template< typename TValue, typename TTensor >
+void
+HessianImageFilter<TInputImage,TOutputImage,TRealType>
+::ComputeHessianScanline( const TValue *in,
+                          TTensor *out,
+                          SizeValueType length,
+                          const OffsetValueType *stride,
+                          const RealType *diagonalScale,
+                          const RealType *crossScale,
+                          const DispatchBase & )
+{
+  typedef typename TTensor::ValueType ComponentType;
+
+  const unsigned int ImageDimension = TInputImage::ImageDimension;
+
+  for ( SizeValueType x = 0; x < length; ++x, ++in )
+    {
+    TTensor &H = out[x];
+    const RealType   c2 = 2.0 * static_cast<RealType>( in[0] );
+
+    // the components are written in the order they are stored in
+    // the symmetric tensor, the upper triangle by rows
+    unsigned int k = 0;
+    unsigned int m = 0;
+    for ( unsigned int i = 0; i < ImageDimension; ++i )
+      {
+      const OffsetValueType si = stride[i];
+
+      H[k++] = static_cast<ComponentType>( ( static_cast<RealType>( in[si] )
+                                             + static_cast<RealType>( in[-si] )
+                                             - c2 ) * diagonalScale[i] );
+
+      for ( unsigned int j = i + 1; j < ImageDimension; ++j )
+        {
+        const OffsetValueType sj = stride[j];
+
+        H[k++] = static_cast<ComponentType>( ( static_cast<RealType>( in[-si-sj] )
+                                               - static_cast<RealType>( in[-si+sj] )
+                                               - static_cast<RealType>( in[si-sj] )
+                                               + static_cast<RealType>( in[si+sj] ) ) * crossScale[m++] );
+        }
+      }
+    }
+}
+
+template <typename TInputImage, typename TOutputImage, typename TRealType >
+template< typename TValue, typename TTensor >
+void
+HessianImageFilter<TInputImage,TOutputImage,TRealType>
+::ComputeHessianScanline( const TValue *in,
+                          TTensor *out,
+                          SizeValueType length,
+                          const OffsetValueType *stride,
+                          const RealType *diagonalScale,
+                          const RealType *crossScale,
+                          const Dispatch<2> & )
+{
+  typedef typename TTensor::ValueType ComponentType;
+
+  const OffsetValueType sx = stride[0];
+  const OffsetValueType sy = stride[1];
+
+  const RealType dxx = diagonalScale[0];
+  const RealType dyy = diagonalScale[1];
+  const RealType dxy = crossScale[0];
+
+  for ( SizeValueType x = 0; x < length; ++x, ++in )
+    {
+    TTensor &H = out[x];
+
+    const RealType c2 = 2.0 * static_cast<RealType>( in[0] );
+
+    H[0] = static_cast<ComponentType>( ( static_cast<RealType>( in[sx] ) + static_cast<RealType>( in[-sx] ) - c2 ) * dxx );
+    H[1] = static_cast<ComponentType>( ( static_cast<RealType>( in[-sx-sy] ) - static_cast<RealType>( in[-sx+sy] )
+                                         - static_cast<RealType>( in[sx-sy] ) + static_cast<RealType>( in[sx+sy] ) ) * dxy );
+    H[2] = static_cast<ComponentType>( ( static_cast<RealType>( in[sy] ) + static_cast<RealType>( in[-sy] ) - c2 ) * dyy );
+    }
+}
+
+template <typename TInputImage, typename TOutputImage, typename TRealType >
+template< typename TValue, typename TTensor >
+void
+HessianImageFilter<TInputImage,TOutputImage,TRealType>
+::ComputeHessianScanline( const TValue *in,
+                          TTensor *out,
+                          SizeValueType length,
+                          const OffsetValueType *stride,
+                          const RealType *diagonalScale,
+                          const RealType *crossScale,
+                          const Dispatch<3> & )
+{
+  typedef typename TTensor::ValueType ComponentType;
+
+  const OffsetValueType sx = stride[0];
+  const OffsetValueType sy = stride[1];
+  const OffsetValueType sz = stride[2];
+
+  const RealType dxx = diagonalScale[0];
+  const RealType dyy = diagonalScale[1];
+  const RealType dzz = diagonalScale[2];
+  const RealType dxy = crossScale[0];
+  const RealType dxz = crossScale[1];
+  const RealType dyz = crossScale[2];
+
+  for ( SizeValueType x = 0; x < length; ++x, ++in )
+    {
+    TTensor &H = out[x];
+
+    const RealType c2 = 2.0 * static_cast<RealType>( in[0] );
+
+    H[0] = static_cast<ComponentType>( ( static_cast<RealType>( in[sx] ) + static_cast<RealType>( in[-sx] ) - c2 ) * dxx );
+    H[1] = static_cast<ComponentType>( ( static_cast<RealType>( in[-sx-sy] ) - static_cast<RealType>( in[-sx+sy] )
+                                         - static_cast<RealType>( in[sx-sy] ) + static_cast<RealType>( in[sx+sy] ) ) * dxy );
+    H[2] = static_cast<ComponentType>( ( static_cast<RealType>( in[-sx-sz] ) - static_cast<RealType>( in[-sx+sz] )
+                                         - static_cast<RealType>( in[sx-sz] ) + static_cast<RealType>( in[sx+sz] ) ) * dxz );
+    H[3] = static_cast<ComponentType>( ( static_cast<RealType>( in[sy] ) + static_cast<RealType>( in[-sy] ) - c2 ) * dyy );
+    H[4] = static_cast<ComponentType>( ( static_cast<RealType>( in[-sy-sz] ) - static_cast<RealType>( in[-sy+sz] )
+                                         - static_cast<RealType>( in[sy-sz] ) + static_cast<RealType>( in[sy+sz] ) ) * dyz );
+    H[5] = static_cast<ComponentType>( ( static_cast<RealType>( in[sz] ) + static_cast<RealType>( in[-sz] ) - c2 ) * dzz );
+    }
+}
+
 /**
  * Threaded Data Generation
  */
-template <typename TInputImage, typename TOutputImage >
+template <typename TInputImage, typename TOutputImage, typename TRealType >
 void
-HessianImageFilter<TInputImage,TOutputImage>
+HessianImageFilter<TInputImage,TOutputImage,TRealType>
 ::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
                        ThreadIdType threadId)
+{
+  this->DispatchedThreadedGenerateData( outputRegionForThread, threadId, static_cast< OutputPixelType * >( ITK_NULLPTR ) );
+}
+
+/**
+ * Split a region into tiles along the first two dimensions
+ */
+template <typename TInputImage, typename TOutputImage, typename TRealType >
+void
+HessianImageFilter<TInputImage,TOutputImage,TRealType>
+::SplitIntoTiles( const OutputImageRegionType &region, std::vector< OutputImageRegionType > &tiles ) const
+{
+  const unsigned int ImageDimension = TInputImage::ImageDimension;
+
+  tiles.clear();
+
+  // Each pixel reads 3 slices of the input. The tiles are traversed
+  // along the remaining dimensions, so the 3 slices of a tile are
+  // reused from the cache when they fit in the CacheBlockSize.
+  const SizeValueType sliceBytes = 3 * sizeof( PixelType ) * region.GetSize(0)
+    * ( ImageDimension > 1 ? region.GetSize(1) : 1 );
+
+  if ( ImageDimension < 3 || m_CacheBlockSize == 0 || sliceBytes <= m_CacheBlockSize )
+    {
+    tiles.push_back( region );
+    return;
+    }
+
+  const SizeValueType pixelsPerTile = std::max< SizeValueType >( m_CacheBlockSize / ( 3 * sizeof( PixelType ) ), 1 );
+
+  // keep whole rows when at least a few rows fit in a tile, then
+  // fill the tile with rows
+  SizeValueType tileSize[2];
+  tileSize[0] = region.GetSize(0);
+  if ( tileSize[0] * 8 > pixelsPerTile )
+    {
+    tileSize[0] = std::max< SizeValueType >( pixelsPerTile / 8, 1 );
+    }
+  tileSize[1] = std::max< SizeValueType >( pixelsPerTile / tileSize[0], 1 );
+
+  OutputImageRegionType tile = region;
+  for ( SizeValueType y = 0; y < region.GetSize(1); y += tileSize[1] )
+    {
+    tile.SetIndex( 1, region.GetIndex(1) + static_cast< IndexValueType >( y ) );
+    tile.SetSize( 1, std::min( tileSize[1], region.GetSize(1) - y ) );
+    for ( SizeValueType x = 0; x < region.GetSize(0); x += tileSize[0] )
+      {
+      tile.SetIndex( 0, region.GetIndex(0) + static_cast< IndexValueType >( x ) );
+      tile.SetSize( 0, std::min( tileSize[0], region.GetSize(0) - x ) );
+      tiles.push_back( tile );
+      }
+    }
+}
+
+/**
+ * Compute the Hessian of the thread's region for the writer
+ */
+template <typename TInputImage, typename TOutputImage, typename TRealType >
+template< typename TWriter >
+void
+HessianImageFilter<TInputImage,TOutputImage,TRealType>
+::ThreadedComputeHessian(const OutputImageRegionType& outputRegionForThread,
+                         ThreadIdType threadId,
+                         TWriter &writer)
 {
   ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels() );
 
+  this->ComputeHessianRegion( outputRegionForThread, writer, progress );
+}
+
+/**
+ * Faces and buffers of a thread's region
+ */
+template <typename TInputImage, typename TOutputImage, typename TRealType >
+void
+HessianImageFilter<TInputImage,TOutputImage,TRealType>
+::InitializeThreadBuffers( const OutputImageRegionType &region, ThreadBuffers &buffers ) const
+{
+  itk::Size<TInputImage::ImageDimension> radius;
+  radius.Fill( 1 );
+
+  NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< TInputImage > bC;
+  buffers.Faces = bC( this->GetInput(), region, radius );
+
+  // allocated by the first region computed with smoothing
+  buffers.SliceBuffer = RealImageType::New();
+  buffers.Temp1 = RealImageType::New();
+  buffers.Temp2 = RealImageType::New();
+}
+
+/**
+ * Compute the Hessian of the region for the writer
+ */
+template <typename TInputImage, typename TOutputImage, typename TRealType >
+template< typename TWriter >
+void
+HessianImageFilter<TInputImage,TOutputImage,TRealType>
+::ComputeHessianRegion(const OutputImageRegionType& region,
+                       TWriter &writer,
+                       ProgressReporter &progress)
+{
+  ThreadBuffers buffers;
+  this->InitializeThreadBuffers( region, buffers );
+
+  this->ComputeHessianRegion( region, writer, progress, buffers );
+}
+
+/**
+ * Compute the Hessian of a part of the buffers' region for the writer
+ */
+template <typename TInputImage, typename TOutputImage, typename TRealType >
+template< typename TWriter >
+void
+HessianImageFilter<TInputImage,TOutputImage,TRealType>
+::ComputeHessianRegion(const OutputImageRegionType& region,
+                       TWriter &writer,
+                       ProgressReporter &progress,
+                       ThreadBuffers &buffers)
+{
+  if ( m_Sigma > 0.0 )
+    {
+    this->ComputeHessianRegionWithSmoothing( region, writer, progress, buffers );
+    return;
+    }
+
   const TInputImage *input = this->GetInput();
 
   const unsigned int ImageDimension = TInputImage::ImageDimension;
@@ -115,47 +492,89 @@ HessianImageFilter<TInputImage,TOutputImage>
   TOutputImage *output = this->GetOutput();
 
 
-  typedef typename OutputImageType::PixelType HessianType;
+  typedef typename TWriter::TensorType HessianType;
   ImageRegionIterator<OutputImageType> oit;
 
   itk::Size<ImageDimension> radius;
   radius.Fill( 1 );
-  unsigned long center;
-  unsigned long stride[ImageDimension];
 
-  typename TInputImage::SpacingType spacing = input->GetSpacing();
+  // scale factors for the central differences
+  RealType diagonalScale[ImageDimension];
+  RealType crossScale[ImageDimension*(ImageDimension+1)/2];
+  this->ComputeDifferenceScales( diagonalScale, crossScale );
+  unsigned int m;
 
+  typedef ConstNeighborhoodIterator< TInputImage > NeighborhoodType;
 
-  // compute the boundary faces of our region
-  typename NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< TInputImage >::FaceListType faceList;
-  NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< TInputImage > bC;
-  faceList = bC( input, outputRegionForThread, radius );
+  // The faces of the buffers' region are cropped to the region. The
+  // first face is the region whose neighborhood is completely inside
+  // the input buffer, it is computed directly from the input buffer
+  // along scanlines.
+  for ( typename FaceListType::const_iterator fit = buffers.Faces.begin(); fit != buffers.Faces.end(); ++fit )
+    {
+    OutputImageRegionType face = *fit;
+    if ( face.GetNumberOfPixels() == 0 || !face.Crop( region ) )
+      {
+      continue;
+      }
 
-  typename NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< TInputImage >::FaceListType::iterator fit;
+    if ( fit == buffers.Faces.begin() )
+      {
+      const PixelType *inputBuffer = input->GetBufferPointer();
 
-  typedef ConstNeighborhoodIterator< TInputImage > NeighborhoodType;
+      OffsetValueType inputStride[ImageDimension];
+      for ( unsigned int i = 0; i < ImageDimension; ++i )
+        {
+        inputStride[i] = input->GetOffsetTable()[i];
+        }
 
-  // get center and dimension strides for iterator neighborhoods
-  NeighborhoodType it( radius, input, *faceList.begin() );
-  center = it.Size()/2;
-  for ( unsigned int i = 0; i < ImageDimension; ++i )
-    {
-    stride[i] = it.GetStride(i);
-    }
+      std::vector< OutputImageRegionType > tiles;
+      this->SplitIntoTiles( face, tiles );
 
-  // process each of the region "faces"
-  for ( fit = faceList.begin(); fit != faceList.end(); ++fit )
-    {
-    // set up the iterator for the "face" and let the automatic
-    // boundary condition detection work as needed
-    it = NeighborhoodType( radius, input, *fit);
+      typedef ImageScanlineIterator<OutputImageType> OutputScanlineIteratorType;
+      for ( size_t t = 0; t < tiles.size(); ++t )
+        {
+        OutputScanlineIteratorType sit( output, tiles[t] );
+
+        const SizeValueType ln = tiles[t].GetSize(0);
+
+        while ( !sit.IsAtEnd() )
+          {
+          const PixelType *in = inputBuffer + input->ComputeOffset( sit.GetIndex() );
+          OutputPixelType *out = &sit.Value();
+
+          ComputeHessianScanline( in, writer.BeginScanline( out, ln ), ln, inputStride, diagonalScale, crossScale );
+          writer.EndScanline( out, ln );
+
+          for ( SizeValueType x = 0; x < ln; ++x )
+            {
+            progress.CompletedPixel();
+            }
+          sit.NextLine();
+          }
+        }
+      continue;
+      }
+
+    // set up the iterator for the boundary "face" and let the
+    // automatic boundary condition detection work as needed
+    NeighborhoodType it( radius, input, face );
+
+    // get center and dimension strides for iterator neighborhoods
+    const unsigned long center = it.Size()/2;
+    unsigned long       stride[ImageDimension];
+    for ( unsigned int i = 0; i < ImageDimension; ++i )
+      {
+      stride[i] = it.GetStride(i);
+      }
 
-    oit = ImageRegionIterator<OutputImageType>( output, *fit );
+    oit = ImageRegionIterator<OutputImageType>( output, face );
 
     while ( !it.IsAtEnd() )
       {
       // symetric hessian
-      HessianType H;
+      OutputPixelType *out = &oit.Value();
+      HessianType &H = *writer.BeginScanline( out, 1 );
 
 
       //Calculate 2nd order derivative on the diaganal
@@ -163,10 +582,11 @@ HessianImageFilter<TInputImage,TOutputImage>
         {
         H(i,i) = it.GetPixel(center + stride[i]) + it.GetPixel(center - stride[i])
           - 2.0 * it.GetPixel(center);
-        H(i,i) /= spacing[i] * spacing[i];
+        H(i,i) *= diagonalScale[i];
         }
 
       //Calculate the 2nd derivatives
+      m = 0;
       for ( unsigned int i = 0; i < ImageDimension - 1; i++ )
         {
         for ( unsigned int j = i + 1; j < ImageDimension; j++ )
@@ -175,11 +595,11 @@ HessianImageFilter<TInputImage,TOutputImage>
                      - it.GetPixel(center - stride[i] + stride[j])
                      - it.GetPixel(center + stride[i] - stride[j])
                      + it.GetPixel(center + stride[i] + stride[j])
-            ) / ( 4.0 * spacing[i] * spacing[j] );
+            ) * crossScale[m++];
           }
         }
 
-      oit.Set( H );
+      writer.EndScanline( out, 1 );
 
       ++oit;
       ++it;
@@ -189,6 +609,551 @@ HessianImageFilter<TInputImage,TOutputImage>
 
 }
 
+
+/**
+ * Smooth one slice of the input
+ */
+template <typename TInputImage, typename TOutputImage, typename TRealType >
+void
+HessianImageFilter<TInputImage,TOutputImage,TRealType>
+::SmoothSlice( IndexValueType slice,
+               unsigned int slot,
+               RealImageType *sliceBuffer,
+               RealImageType *temp1,
+               RealImageType *temp2 )
+{
+  const unsigned int lastDim = TInputImage::ImageDimension - 1;
+
+  typedef typename InputImageType::IndexType     IndexType;
+  typedef ImageScanlineIterator< RealImageType > RealIteratorType;
+
+  const InputImageType *input = this->GetInput();
+  const PixelType      *inputBuffer = input->GetBufferPointer();
+
+  const typename InputImageType::RegionType &bufferedRegion = input->GetBufferedRegion();
+
+  // The smoothing region is the in slice extent needed to compute
+  // the slice padded by 1, with the radius of the kernel. It is
+  // cropped to the input's buffered region, so clamping to it
+  // replicates the boundary of the input.
+  const typename RealImageType::RegionType &smoothRegion = temp1->GetBufferedRegion();
+  const SizeValueType ln = smoothRegion.GetSize(0);
+
+  // convolve along the last dimension directly from the input buffer
+  {
+  const std::vector< RealType > &kernel = m_GaussianKernels[lastDim];
+  const IndexValueType           r = static_cast< IndexValueType >( kernel.size() - 1 ) / 2;
+  const IndexValueType           lastBegin = bufferedRegion.GetIndex(lastDim);
+  const IndexValueType           lastEnd = lastBegin + static_cast< IndexValueType >( bufferedRegion.GetSize(lastDim) ) - 1;
+
+  RealIteratorType it( temp1, smoothRegion );
+  while ( !it.IsAtEnd() )
+    {
+    RealType *out = &it.Value();
+    std::fill( out, out + ln, NumericTraits< RealType >::ZeroValue() );
+
+    IndexType idx = it.GetIndex();
+    for ( IndexValueType k = -r; k <= r; ++k )
+      {
+      idx[lastDim] = std::min( std::max( slice + k, lastBegin ), lastEnd );
+
+      const PixelType *in = inputBuffer + input->ComputeOffset( idx );
+      const RealType   w = kernel[k+r];
+      for ( SizeValueType x = 0; x < ln; ++x )
+        {
+        out[x] += w * static_cast< RealType >( in[x] );
+        }
+      }
+    it.NextLine();
+    }
+  }
+
+  // separable convolution along the other dimensions of the slice
+  RealImageType *src = temp1;
+  RealImageType *dst = temp2;
+  for ( unsigned int d = 0; d < lastDim; ++d )
+    {
+    const std::vector< RealType > &kernel = m_GaussianKernels[d];
+    const IndexValueType           r = static_cast< IndexValueType >( kernel.size() - 1 ) / 2;
+    const IndexValueType           begin = smoothRegion.GetIndex(d);
+    const IndexValueType           end = begin + static_cast< IndexValueType >( smoothRegion.GetSize(d) ) - 1;
+
+    RealIteratorType it( dst, smoothRegion );
+    while ( !it.IsAtEnd() )
+      {
+      RealType *out = &it.Value();
+      IndexType idx = it.GetIndex();
+
+      if ( d == 0 )
+        {
+        const RealType *in = src->GetBufferPointer() + src->ComputeOffset( idx );
+        for ( IndexValueType x = 0; x <= end - begin; ++x )
+          {
+          RealType sum = NumericTraits< RealType >::ZeroValue();
+          for ( IndexValueType k = -r; k <= r; ++k )
+            {
+            sum += kernel[k+r] * in[ std::min( std::max( x + k, IndexValueType(0) ), end - begin ) ];
+            }
+          out[x] = sum;
+          }
+        }
+      else
+        {
+        std::fill( out, out + ln, NumericTraits< RealType >::ZeroValue() );
+
+        const IndexValueType center = idx[d];
+        for ( IndexValueType k = -r; k <= r; ++k )
+          {
+          idx[d] = std::min( std::max( center + k, begin ), end );
+
+          const RealType *in = src->GetBufferPointer() + src->ComputeOffset( idx );
+          const RealType  w = kernel[k+r];
+          for ( SizeValueType x = 0; x < ln; ++x )
+            {
+            out[x] += w * in[x];
+            }
+          }
+        }
+      it.NextLine();
+      }
+    std::swap( src, dst );
+    }
+
+  // copy into the slot of the slice buffer, replicating the boundary
+  typename RealImageType::RegionType slotRegion = sliceBuffer->GetBufferedRegion();
+  slotRegion.SetIndex( lastDim, slot );
+  slotRegion.SetSize( lastDim, 1 );
+
+  const SizeValueType  sln = slotRegion.GetSize(0);
+  const IndexValueType begin0 = smoothRegion.GetIndex(0);
+  const IndexValueType end0 = begin0 + static_cast< IndexValueType >( ln ) - 1;
+
+  RealIteratorType it( sliceBuffer, slotRegion );
+  while ( !it.IsAtEnd() )
+    {
+    RealType *out = &it.Value();
+
+    IndexType idx = it.GetIndex();
+    const IndexValueType x0 = idx[0];
+    idx[lastDim] = smoothRegion.GetIndex(lastDim);
+    for ( unsigned int d = 1; d < lastDim; ++d )
+      {
+      const IndexValueType begin = smoothRegion.GetIndex(d);
+      const IndexValueType end = begin + static_cast< IndexValueType >( smoothRegion.GetSize(d) ) - 1;
+      idx[d] = std::min( std::max( idx[d], begin ), end );
+      }
+    idx[0] = begin0;
+
+    const RealType *in = src->GetBufferPointer() + src->ComputeOffset( idx );
+    for ( SizeValueType x = 0; x < sln; ++x )
+      {
+      out[x] = in[ std::min( std::max( x0 + static_cast< IndexValueType >( x ), begin0 ), end0 ) - begin0 ];
+      }
+    it.NextLine();
+    }
+}
+
+
+/**
+ * Compute the Hessian of the region with Gaussian smoothing
+ */
+template <typename TInputImage, typename TOutputImage, typename TRealType >
+template< typename TWriter >
+void
+HessianImageFilter<TInputImage,TOutputImage,TRealType>
+::ComputeHessianRegionWithSmoothing(const OutputImageRegionType& region,
+                                    TWriter &writer,
+                                    ProgressReporter &progress,
+                                    ThreadBuffers &buffers)
+{
+  if ( region.GetNumberOfPixels() == 0 )
+    {
+    return;
+    }
+
+  const unsigned int ImageDimension = TInputImage::ImageDimension;
+  const unsigned int lastDim = ImageDimension - 1;
+
+  typedef typename InputImageType::IndexType IndexType;
+
+  const TInputImage *input = this->GetInput();
+  TOutputImage      *output = this->GetOutput();
+
+  RealType diagonalScale[ImageDimension];
+  RealType crossScale[ImageDimension*(ImageDimension+1)/2];
+  this->ComputeDifferenceScales( diagonalScale, crossScale );
+
+  // Buffer of three consecutive smoothed slices along the last
+  // dimension, padded by one pixel for the central differences. The
+  // buffers of the thread are only reallocated when they grow.
+  typename RealImageType::RegionType sliceRegion = region;
+  sliceRegion.PadByRadius( 1 );
+  sliceRegion.SetIndex( lastDim, 0 );
+  sliceRegion.SetSize( lastDim, 3 );
+
+  RealImageType *sliceBuffer = buffers.SliceBuffer;
+  sliceBuffer->SetRegions( sliceRegion );
+  sliceBuffer->Allocate();
+
+  // Temporary buffers for the separable convolution of one slice
+  typename InputImageType::SizeType radius = this->GetSmoothingRadius();
+  radius[lastDim] = 0;
+
+  typename RealImageType::RegionType smoothRegion = region;
+  smoothRegion.PadByRadius( 1 );
+  smoothRegion.PadByRadius( radius );
+  smoothRegion.Crop( input->GetBufferedRegion() );
+  smoothRegion.SetIndex( lastDim, 0 );
+  smoothRegion.SetSize( lastDim, 1 );
+
+  RealImageType *temp1 = buffers.Temp1;
+  temp1->SetRegions( smoothRegion );
+  temp1->Allocate();
+
+  RealImageType *temp2 = buffers.Temp2;
+  temp2->SetRegions( smoothRegion );
+  temp2->Allocate();
+
+  const IndexValueType lastBegin = input->GetBufferedRegion().GetIndex(lastDim);
+  const IndexValueType lastEnd = lastBegin + static_cast< IndexValueType >( input->GetBufferedRegion().GetSize(lastDim) ) - 1;
+  const IndexValueType zBegin = region.GetIndex(lastDim);
+  const IndexValueType zEnd = zBegin + static_cast< IndexValueType >( region.GetSize(lastDim) );
+
+  for ( unsigned int slot = 0; slot < 3; ++slot )
+    {
+    const IndexValueType z = zBegin + static_cast< IndexValueType >( slot ) - 1;
+    this->SmoothSlice( std::min( std::max( z, lastBegin ), lastEnd ), slot, sliceBuffer, temp1, temp2 );
+    }
+
+  RealType *sliceBufferPointer = sliceBuffer->GetBufferPointer();
+
+  OffsetValueType stride[ImageDimension];
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+    stride[i] = sliceBuffer->GetOffsetTable()[i];
+    }
+  const OffsetValueType slotSize = stride[lastDim];
+
+  const SizeValueType ln = region.GetSize(0);
+
+  OutputImageRegionType outputSliceRegion = region;
+  outputSliceRegion.SetSize( lastDim, 1 );
+
+  for ( IndexValueType z = zBegin; z < zEnd; ++z )
+    {
+    if ( z != zBegin )
+      {
+      // shift the slices down and smooth the next one
+      std::copy( sliceBufferPointer + slotSize, sliceBufferPointer + 3*slotSize, sliceBufferPointer );
+      this->SmoothSlice( std::min( std::max( z + 1, lastBegin ), lastEnd ), 2, sliceBuffer, temp1, temp2 );
+      }
+
+    outputSliceRegion.SetIndex( lastDim, z );
+
+    typedef ImageScanlineIterator<OutputImageType> OutputScanlineIteratorType;
+    OutputScanlineIteratorType sit( output, outputSliceRegion );
+
+    while ( !sit.IsAtEnd() )
+      {
+      IndexType idx = sit.GetIndex();
+      idx[lastDim] = 1;
+
+      const RealType  *in = sliceBufferPointer + sliceBuffer->ComputeOffset( idx );
+      OutputPixelType *out = &sit.Value();
+
+      ComputeHessianScanline( in, writer.BeginScanline( out, ln ), ln, stride, diagonalScale, crossScale );
+      writer.EndScanline( out, ln );
+
+      for ( SizeValueType x = 0; x < ln; ++x )
+        {
+        progress.CompletedPixel();
+        }
+      sit.NextLine();
+      }
+    }
+}
+
+/**
+ * Evaluate the Hessian at the indices
+ */
+template <typename TInputImage, typename TOutputImage, typename TRealType >
+void
+HessianImageFilter<TInputImage,TOutputImage,TRealType>
+::EvaluateAtIndices( const IndexListType &indices, OutputPixelListType &values )
+{
+  values.resize( indices.size() );
+
+  const InputImageType * input = this->GetInput();
+  if ( !input )
+    {
+    itkExceptionMacro( << "Input image not set" );
+    }
+
+  if ( indices.empty() )
+    {
+    return;
+    }
+
+  const InputImageRegionType largestRegion = input->GetLargestPossibleRegion();
+
+  // the bounding box of the indices' neighborhoods must be buffered
+  IndexType lower = indices[0];
+  IndexType upper = indices[0];
+  for ( size_t n = 0; n < indices.size(); ++n )
+    {
+    if ( !largestRegion.IsInside( indices[n] ) )
+      {
+      itkExceptionMacro( << "Index " << indices[n] << " is outside of the input's largest possible region "
+                         << largestRegion );
+      }
+    for ( unsigned int i = 0; i < TInputImage::ImageDimension; ++i )
+      {
+      lower[i] = std::min( lower[i], indices[n][i] );
+      upper[i] = std::max( upper[i], indices[n][i] );
+      }
+    }
+
+  typename InputImageType::SizeType radius = this->GetSmoothingRadius();
+  typename InputImageType::SizeType size;
+  for ( unsigned int i = 0; i < TInputImage::ImageDimension; ++i )
+    {
+    radius[i] += 1;
+    size[i] = static_cast< SizeValueType >( upper[i] - lower[i] + 1 );
+    }
+
+  InputImageRegionType neededRegion( lower, size );
+  neededRegion.PadByRadius( radius );
+  neededRegion.Crop( largestRegion );
+
+  if ( !input->GetBufferedRegion().IsInside( neededRegion ) )
+    {
+    itkExceptionMacro( << "The input's buffered region " << input->GetBufferedRegion()
+                       << " does not contain the neighborhoods of the indices " << neededRegion
+                       << ", the input must be updated first" );
+    }
+
+  this->InitializeGaussianKernels();
+
+  EvaluateThreadStruct str;
+  str.Filter = this;
+  str.Indices = &indices[0];
+  str.Values = &values[0];
+  str.NumberOfIndices = indices.size();
+
+  const ThreadIdType numberOfThreads = static_cast< ThreadIdType >(
+    std::min< SizeValueType >( this->GetNumberOfThreads(), indices.size() ) );
+
+  // a threader of its own, so the filter's threader is left as it
+  // was configured for the pipeline
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( numberOfThreads );
+  threader->SetSingleMethod( Self::EvaluateThreaderCallback, &str );
+  threader->SingleMethodExecute();
+}
+
+/**
+ * Evaluate the Hessian at the non-zero pixels of the mask
+ */
+template <typename TInputImage, typename TOutputImage, typename TRealType >
+template< typename TMaskImage >
+void
+HessianImageFilter<TInputImage,TOutputImage,TRealType>
+::EvaluateAtMask( const TMaskImage *mask, IndexListType &indices, OutputPixelListType &values )
+{
+  if ( !mask )
+    {
+    itkExceptionMacro( << "Mask image not set" );
+    }
+
+  typedef typename TMaskImage::PixelType MaskPixelType;
+
+  indices.clear();
+  ImageRegionConstIteratorWithIndex< TMaskImage > it( mask, mask->GetBufferedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    if ( it.Get() != NumericTraits< MaskPixelType >::ZeroValue() )
+      {
+      indices.push_back( it.GetIndex() );
+      }
+    }
+
+  this->EvaluateAtIndices( indices, values );
+}
+
+template <typename TInputImage, typename TOutputImage, typename TRealType >
+ITK_THREAD_RETURN_TYPE
+HessianImageFilter<TInputImage,TOutputImage,TRealType>
+::EvaluateThreaderCallback( void *arg )
+{
+  const MultiThreader::ThreadInfoStruct *info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  const ThreadIdType threadId = info->ThreadID;
+  const ThreadIdType numberOfThreads = info->NumberOfThreads;
+  EvaluateThreadStruct *str = static_cast< EvaluateThreadStruct * >( info->UserData );
+
+  const SizeValueType begin = str->NumberOfIndices * threadId / numberOfThreads;
+  const SizeValueType end = str->NumberOfIndices * ( threadId + 1 ) / numberOfThreads;
+
+  if ( begin < end )
+    {
+    str->Filter->ThreadedEvaluateAtIndices( str->Indices + begin, str->Values + begin, end - begin );
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <typename TInputImage, typename TOutputImage, typename TRealType >
+void
+HessianImageFilter<TInputImage,TOutputImage,TRealType>
+::ThreadedEvaluateAtIndices( const IndexType *indices, OutputPixelType *values, SizeValueType count )
+{
+  this->DispatchedEvaluateAtIndices( indices, values, count, static_cast< OutputPixelType * >( ITK_NULLPTR ) );
+}
+
+/**
+ * Evaluate the indices of one thread
+ */
+template <typename TInputImage, typename TOutputImage, typename TRealType >
+template< typename TWriter >
+void
+HessianImageFilter<TInputImage,TOutputImage,TRealType>
+::ThreadedComputeHessianAtIndices( const IndexType *indices, OutputPixelType *values, SizeValueType count, TWriter &writer )
+{
+  const unsigned int ImageDimension = TInputImage::ImageDimension;
+
+  const InputImageType *input = this->GetInput();
+  const InputImageRegionType bufferedRegion = input->GetBufferedRegion();
+  const IndexType lower = bufferedRegion.GetIndex();
+  const IndexType upper = bufferedRegion.GetUpperIndex();
+
+  typename InputImageType::SizeType radius;
+  radius.Fill( 0 );
+  if ( !m_GaussianKernels.empty() )
+    {
+    radius = this->GetSmoothingRadius();
+    }
+
+  RealType diagonalScale[ImageDimension];
+  RealType crossScale[ImageDimension*(ImageDimension+1)/2];
+  this->ComputeDifferenceScales( diagonalScale, crossScale );
+
+  // the 3x3x... stencil of the central differences
+  OffsetValueType stencilStride[ImageDimension];
+  OffsetValueType stencilCenter = 0;
+  for ( unsigned int i = 0, s = 1; i < ImageDimension; s *= 3, ++i )
+    {
+    stencilStride[i] = s;
+    stencilCenter += s;
+    }
+
+  const PixelType       *inputBuffer = input->GetBufferPointer();
+  const OffsetValueType *offsetTable = input->GetOffsetTable();
+
+  std::vector< RealType >        block;
+  std::vector< RealType >        temp;
+  std::vector< OffsetValueType > offsets[ImageDimension];
+  SizeValueType                  extent[ImageDimension];
+  SizeValueType                  c[ImageDimension];
+
+  for ( SizeValueType n = 0; n < count; ++n )
+    {
+    const IndexType &p = indices[n];
+
+    // the buffer offsets of the stencil and the support of the
+    // smoothing along each dimension, with the indices clamped to the
+    // buffered region
+    SizeValueType blockSize = 1;
+    for ( unsigned int i = 0; i < ImageDimension; ++i )
+      {
+      extent[i] = 3 + 2 * radius[i];
+      blockSize *= extent[i];
+      c[i] = 0;
+
+      offsets[i].resize( extent[i] );
+      for ( SizeValueType k = 0; k < extent[i]; ++k )
+        {
+        const IndexValueType x = p[i] - 1 - static_cast< IndexValueType >( radius[i] )
+                                 + static_cast< IndexValueType >( k );
+        offsets[i][k] = ( std::min( std::max( x, lower[i] ), upper[i] ) - lower[i] ) * offsetTable[i];
+        }
+      }
+
+    // copy the block by lines of the first dimension
+    block.resize( blockSize );
+    RealType *b = &block[0];
+    for ( SizeValueType line = 0; line < blockSize / extent[0]; ++line )
+      {
+      OffsetValueType lineOffset = 0;
+      for ( unsigned int i = 1; i < ImageDimension; ++i )
+        {
+        lineOffset += offsets[i][c[i]];
+        }
+
+      const PixelType *in = inputBuffer + lineOffset;
+      for ( SizeValueType x = 0; x < extent[0]; ++x )
+        {
+        *b++ = static_cast< RealType >( in[offsets[0][x]] );
+        }
+
+      for ( unsigned int i = 1; i < ImageDimension && ++c[i] == extent[i]; ++i )
+        {
+        c[i] = 0;
+        }
+      }
+
+    // reduce each dimension to the 3 smoothed values of the stencil
+    for ( unsigned int d = 0; d < ImageDimension && !m_GaussianKernels.empty(); ++d )
+      {
+      const std::vector< RealType > &kernel = m_GaussianKernels[d];
+
+      OffsetValueType stride = 1;
+      for ( unsigned int i = 0; i < d; ++i )
+        {
+        stride *= extent[i];
+        }
+
+      // the start of the support in the block of each stencil point,
+      // which is not centered at the boundary
+      OffsetValueType start[3];
+      for ( IndexValueType j = 0; j < 3; ++j )
+        {
+        const IndexValueType x = std::min( std::max( p[d] - 1 + j, lower[d] ), upper[d] );
+        start[j] = ( x - p[d] + 1 ) * stride;
+        }
+
+      SizeValueType tempSize = blockSize / extent[d] * 3;
+      temp.resize( tempSize );
+
+      const SizeValueType outer = blockSize / ( stride * extent[d] );
+      RealType *out = &temp[0];
+      for ( SizeValueType o = 0; o < outer; ++o )
+        {
+        for ( unsigned int j = 0; j < 3; ++j )
+          {
+          for ( OffsetValueType l = 0; l < stride; ++l )
+            {
+            const RealType *in = &block[o * stride * extent[d] + start[j] + l];
+            RealType sum = NumericTraits< RealType >::ZeroValue();
+            for ( size_t k = 0; k < kernel.size(); ++k, in += stride )
+              {
+              sum += kernel[k] * *in;
+              }
+            *out++ = sum;
+            }
+          }
+        }
+
+      block.swap( temp );
+      blockSize = tempSize;
+      extent[d] = 3;
+      }
+
+    OutputPixelType *out = values + n;
+    ComputeHessianScanline( &block[stencilCenter], writer.BeginScanline( out, 1 ), 1,
+                            stencilStride, diagonalScale, crossScale );
+    writer.EndScanline( out, 1 );
+    }
+}
+
 } // end namespace itk
 
 #endif // itkHessianImageFilter_hxx
@@ -19,17 +19,64 @@
 #define itkObjectnessMeasureImageFilter_h
 
 #include "itkImageToImageFilter.h"
+#include "itkHessianImageFilter.h"
+#include "itkProgressReporter.h"
+#include "itkSymmetricSecondRankTensor.h"
+#include "itkSymmetricEigenValuesClosedForm.h"
+
+#include <vector>
 
 namespace itk
 {
 /** \class ObjectnessMeasureImageFilter
  *
- * This is a composite filter which combines a computation of the
- * hessian with computation of the objectness.
+ * This filter combines a computation of the hessian with computation
+ * of the objectness.
+ *
+ * The Hessian of each scanline is computed by an internal
+ * HessianImageFilter into a buffer, and its eigenvalues and
+ * objectness are computed in the same threaded pass, so no tensor
+ * image is allocated. The objectness is the same as the one of the
+ * HessianToObjectnessMeasureImageFilter, except that the eigenvalues of
+ * 2D and 3D images are computed by the closed form
+ * SymmetricEigenValuesClosedForm.
+ *
+ * Only the requested region of the output is computed, from the
+ * requested region padded by the radius of the Hessian, so the filter
+ * can be streamed.
+ *
+ * When NumberOfSigmaSteps is greater than zero, the objectness is
+ * computed at NumberOfSigmaSteps scales between SigmaMinimum and
+ * SigmaMaximum, logarithmically spaced, with the Hessian normalized
+ * by sigma^2. Each scale reports an equal part of the progress. The
+ * maximum over the scales is updated in place in the output, and the
+ * sigma of the maximum in the optional scales output, so only these
+ * two images are allocated for any number of scales. Otherwise the
+ * single scale Sigma is computed without normalization.
+ *
+ * TInternalType is the precision of the Hessian, including the
+ * smoothing, of the eigenvalues and of the objectness. A float
+ * TInternalType halves the size of the buffers and the memory they
+ * move, at the cost of the precision of float.
+ *
+ * The optional mask image restricts the computation to its nonzero
+ * pixels, the other pixels of the output are 0. The Hessian is
+ * computed for each run of consecutive masked pixels along the first
+ * dimension, from the input around the run. The boundary faces and
+ * the smoothing buffers are computed once per thread and shared by its
+ * runs. Without smoothing a masked pixel costs as much as a pixel of
+ * the unmasked image. With a Sigma greater than 0 the smoothing is
+ * recomputed for each run, over the run padded by the kernel radius
+ * in every dimension, so the scattered pixels of a sparse mask each
+ * cost the smoothing of about radius^(ImageDimension-1) pixels, that
+ * is radius^2 x taps operations in 3D. The mask then only saves time
+ * for long runs.
+ *
+ * \sa HessianToObjectnessMeasureImageFilter
  *
  * \ingroup SimpleITKFiltersModule
  */
-template< typename TInputImage, typename TOutputImage >
+template< typename TInputImage, typename TOutputImage, typename TInternalType = double >
 class ObjectnessMeasureImageFilter
   : public ImageToImageFilter< TInputImage, TOutputImage >
 {
@@ -44,8 +91,11 @@ public:
 
   typedef typename Superclass::InputImageType  InputImageType;
   typedef typename Superclass::OutputImageType OutputImageType;
+  typedef typename OutputImageType::PixelType  OutputPixelType;
 
-  typedef double                                   InternalType;
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+
+  typedef TInternalType                            InternalType;
 
   /** Image dimension */
   itkStaticConstMacro(ImageDimension, unsigned int, InputImageType::ImageDimension);
@@ -57,6 +107,19 @@ public:
   /** Runtime information support. */
   itkTypeMacro(ObjectnessMeasureImageFilter, ImageToImageFilter);
 
+  typedef SymmetricSecondRankTensor< InternalType, ImageDimension > TensorType;
+  typedef typename TensorType::EigenValuesArrayType                 EigenValueArrayType;
+
+  /** Image of the sigma of the maximum objectness */
+  typedef float                                    ScalesPixelType;
+  typedef Image< ScalesPixelType, ImageDimension > ScalesImageType;
+
+  typedef ProcessObject::DataObjectPointerArraySizeType DataObjectPointerArraySizeType;
+
+  /** Image of the pixels to compute */
+  typedef unsigned char                          MaskPixelType;
+  typedef Image< MaskPixelType, ImageDimension > MaskImageType;
+
 
   /** Set/Get Alpha, the weight corresponding to R_A
    * (the ratio of the smallest eigenvalue that has to be large to the larger ones).
@@ -93,6 +156,73 @@ public:
   itkGetConstMacro(BrightObject, bool);
   itkBooleanMacro(BrightObject);
 
+  /** Set/Get the sigma of the Gaussian smoothing of the Hessian of
+   * the single scale mode, in physical units. The default 0 computes
+   * the Hessian without smoothing. */
+  itkSetClampMacro(Sigma, double, 0.0, NumericTraits<double>::max());
+  itkGetConstMacro(Sigma, double);
+
+  /** Set/Get the range of the scales of the multiscale mode, both
+   * must be greater than 0 when NumberOfSigmaSteps is not 0 */
+  itkSetClampMacro(SigmaMinimum, double, 0.0, NumericTraits<double>::max());
+  itkGetConstMacro(SigmaMinimum, double);
+  itkSetClampMacro(SigmaMaximum, double, 0.0, NumericTraits<double>::max());
+  itkGetConstMacro(SigmaMaximum, double);
+
+  /** Set/Get the number of scales, 0 computes the single scale Sigma */
+  itkSetMacro(NumberOfSigmaSteps, unsigned int);
+  itkGetConstMacro(NumberOfSigmaSteps, unsigned int);
+
+  /** Toggle the output of the sigma of the maximum objectness */
+  itkSetMacro(GenerateScalesOutput, bool);
+  itkGetConstMacro(GenerateScalesOutput, bool);
+  itkBooleanMacro(GenerateScalesOutput);
+
+  /** Set/Get the threshold on the Frobenius norm of the Hessian below
+   * which the objectness is 0 without computing the eigenvalues. In
+   * flat regions the objectness is nearly 0 after the Gamma weighting,
+   * below a norm of Gamma/10 it is less than 0.005 without
+   * ScaleObjectnessMeasure. The default 0 computes every pixel. */
+  itkSetClampMacro(HessianNormThreshold, double, 0.0, NumericTraits<double>::max());
+  itkGetConstMacro(HessianNormThreshold, double);
+
+  /** Get the fraction of the pixels evaluated by the last update
+   * whose objectness was set to 0 by the HessianNormThreshold, over
+   * all scales. With a mask, only the masked pixels are evaluated. */
+  itkGetConstMacro(FractionOfSkippedPixels, double);
+
+  /** Squared Frobenius norm of a tensor, the sum of its squared
+   * eigenvalues */
+  static InternalType FrobeniusNormSquared( const TensorType &tensor )
+    {
+      InternalType norm = 0.0;
+      unsigned int k = 0;
+      for ( unsigned int i = 0; i < ImageDimension; ++i )
+        {
+        norm += tensor[k] * tensor[k];
+        ++k;
+        for ( unsigned int j = i + 1; j < ImageDimension; ++j, ++k )
+          {
+          norm += 2.0 * tensor[k] * tensor[k];
+          }
+        }
+      return norm;
+    }
+
+  /** Set/Get the optional mask, the objectness is computed only at
+   * its nonzero pixels */
+  void SetMaskImage( const MaskImageType *mask );
+  const MaskImageType * GetMaskImage() const;
+
+  /** Get the image of the sigma of the maximum objectness */
+  const ScalesImageType * GetScalesOutput() const;
+
+  /** Sigma of a scale of the multiscale mode */
+  double ComputeSigma( unsigned int scaleIndex ) const;
+
+  using Superclass::MakeOutput;
+  virtual DataObject::Pointer MakeOutput( DataObjectPointerArraySizeType idx ) ITK_OVERRIDE;
+
 
 protected:
   ObjectnessMeasureImageFilter();
@@ -100,16 +230,196 @@ protected:
   ~ObjectnessMeasureImageFilter();
 
 
-  void EnlargeOutputRequestedRegion(DataObject *output) ITK_OVERRIDE;
+  void GenerateInputRequestedRegion() ITK_OVERRIDE;
+
+  void AllocateOutputs() ITK_OVERRIDE;
+
+  /** Run the threads for each scale */
+  void GenerateData() ITK_OVERRIDE;
 
-  virtual void GenerateData() ITK_OVERRIDE;
+  void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
+  void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId) ITK_OVERRIDE;
+
+  void AfterThreadedGenerateData() ITK_OVERRIDE;
 
   void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
 
+  /** Compute the objectness from the eigenvalues of the Hessian */
+  InternalType ComputeObjectness( const EigenValueArrayType &eigenValues ) const;
+
+  /** Select the closed form eigenvalues of 2D and 3D at compile
+   * time, DispatchBase is the N-D version */
+  struct DispatchBase {};
+  template< unsigned int VDimension >
+  struct Dispatch : public DispatchBase {};
+
+  /** Compute the eigenvalues of length tensors, with the closed form
+   * SymmetricEigenValuesClosedForm in 2D and 3D */
+  static void ComputeEigenValues( const TensorType *tensors, EigenValueArrayType *eigenValues, SizeValueType length )
+    {
+      ComputeEigenValues( tensors, eigenValues, length, Dispatch< ImageDimension >() );
+    }
+
+  static void ComputeEigenValues( const TensorType *tensors, EigenValueArrayType *eigenValues, SizeValueType length,
+                                  const DispatchBase & );
+  static void ComputeEigenValues( const TensorType *tensors, EigenValueArrayType *eigenValues, SizeValueType length,
+                                  const Dispatch<2> & );
+  static void ComputeEigenValues( const TensorType *tensors, EigenValueArrayType *eigenValues, SizeValueType length,
+                                  const Dispatch<3> & );
+
 private:
   ObjectnessMeasureImageFilter(const Self&);  //purposely not implemented
   void operator=(const Self&);  //purposely not implemented
 
+  /** The HessianImageFilter computing the Hessian of the objectness
+   * from the input into the grafted output. Its computation methods
+   * are made accessible here, so the Hessian's parameters and sparse
+   * evaluation are not part of the interface of the objectness. */
+  class HessianFilter
+    : public HessianImageFilter< TInputImage, TOutputImage, TInternalType >
+  {
+  public:
+    typedef HessianFilter                                                  Self;
+    typedef HessianImageFilter< TInputImage, TOutputImage, TInternalType > Superclass;
+    typedef SmartPointer< Self >                                           Pointer;
+
+    itkNewMacro(Self);
+    itkTypeMacro(HessianFilter, HessianImageFilter);
+
+    typedef typename Superclass::ThreadBuffers ThreadBuffers;
+
+    using Superclass::InitializeThreadBuffers;
+    using Superclass::ComputeHessianRegion;
+    using Superclass::SetSigmaForScale;
+    using Superclass::BeforeThreadedGenerateData;
+
+  protected:
+    HessianFilter() {}
+
+  private:
+    HessianFilter(const Self&); //purposely not implemented
+    void operator=(const Self&); //purposely not implemented
+  };
+
+  /** Computes the Hessian of a scanline into a buffer and writes the
+   * objectness into the output */
+  class ObjectnessScanlineWriter
+  {
+  public:
+    typedef typename Self::TensorType TensorType;
+
+    ObjectnessScanlineWriter( const Self *filter,
+                              InternalType hessianScale = 1.0,
+                              bool accumulate = false,
+                              const OutputPixelType *outputBuffer = ITK_NULLPTR,
+                              ScalesPixelType *scalesBuffer = ITK_NULLPTR,
+                              ScalesPixelType sigma = 0.0 )
+      : m_Filter( filter ),
+        m_HessianScale( hessianScale ),
+        m_Accumulate( accumulate ),
+        m_OutputBuffer( outputBuffer ),
+        m_ScalesBuffer( scalesBuffer ),
+        m_Sigma( sigma ),
+        m_NormThresholdSquared( filter->GetHessianNormThreshold() * filter->GetHessianNormThreshold() ),
+        m_NumberOfSkippedPixels( 0 ),
+        m_NumberOfEvaluatedPixels( 0 )
+      {}
+
+    SizeValueType GetNumberOfSkippedPixels() const
+      {
+      return m_NumberOfSkippedPixels;
+      }
+
+    SizeValueType GetNumberOfEvaluatedPixels() const
+      {
+      return m_NumberOfEvaluatedPixels;
+      }
+
+    TensorType *BeginScanline( OutputPixelType *, SizeValueType length )
+      {
+      if ( m_Buffer.size() < length )
+        {
+        m_Buffer.resize( length );
+        m_EigenValues.resize( length );
+        m_Pixels.resize( length );
+        }
+      return &m_Buffer[0];
+      }
+
+    void EndScanline( OutputPixelType *out, SizeValueType length )
+      {
+      m_NumberOfEvaluatedPixels += length;
+
+      // Write 0 for the flat pixels, and move the others to the front
+      // of the buffer for the eigenvalues.
+      SizeValueType count = 0;
+      for ( SizeValueType x = 0; x < length; ++x )
+        {
+        if ( m_NormThresholdSquared > 0.0
+             && Self::FrobeniusNormSquared( m_Buffer[x] ) * m_HessianScale * m_HessianScale < m_NormThresholdSquared )
+          {
+          this->Write( out, x, NumericTraits< OutputPixelType >::ZeroValue() );
+          ++m_NumberOfSkippedPixels;
+          continue;
+          }
+        if ( count != x )
+          {
+          m_Buffer[count] = m_Buffer[x];
+          }
+        m_Pixels[count++] = x;
+        }
+
+      Self::ComputeEigenValues( &m_Buffer[0], &m_EigenValues[0], count );
+
+      for ( SizeValueType c = 0; c < count; ++c )
+        {
+        EigenValueArrayType &eigenValues = m_EigenValues[c];
+        for ( unsigned int i = 0; i < ImageDimension; ++i )
+          {
+          eigenValues[i] *= m_HessianScale;
+          }
+
+        this->Write( out, m_Pixels[c], static_cast< OutputPixelType >( m_Filter->ComputeObjectness( eigenValues ) ) );
+        }
+      }
+
+  private:
+    void Write( OutputPixelType *out, SizeValueType x, OutputPixelType objectness )
+      {
+      if ( !m_Accumulate || objectness > out[x] )
+        {
+        out[x] = objectness;
+        if ( m_ScalesBuffer )
+          {
+          m_ScalesBuffer[out - m_OutputBuffer + x] = m_Sigma;
+          }
+        }
+      }
+
+    const Self *              m_Filter;
+    InternalType              m_HessianScale;
+    bool                      m_Accumulate;
+    const OutputPixelType *   m_OutputBuffer;
+    ScalesPixelType *         m_ScalesBuffer;
+    ScalesPixelType           m_Sigma;
+    InternalType              m_NormThresholdSquared;
+    SizeValueType             m_NumberOfSkippedPixels;
+    SizeValueType             m_NumberOfEvaluatedPixels;
+    std::vector< TensorType > m_Buffer;
+
+    std::vector< EigenValueArrayType > m_EigenValues;
+    std::vector< SizeValueType >       m_Pixels;
+  };
+
+  /** Compute the runs of masked pixels of the thread's region and
+   * set the other pixels to 0 */
+  void ThreadedComputeHessianInMask( const OutputImageRegionType& outputRegionForThread,
+                                     const MaskImageType *mask,
+                                     ScalesPixelType *scalesBuffer,
+                                     ObjectnessScanlineWriter &writer,
+                                     ProgressReporter &progress );
+
   double       m_Alpha;
   double       m_Beta;
   double       m_Gamma;
@@ -117,6 +427,22 @@ private:
   bool         m_BrightObject;
   bool         m_ScaleObjectnessMeasure;
 
+  double       m_Sigma;
+  double       m_SigmaMinimum;
+  double       m_SigmaMaximum;
+  unsigned int m_NumberOfSigmaSteps;
+  bool         m_GenerateScalesOutput;
+
+  double                       m_HessianNormThreshold;
+  double                       m_FractionOfSkippedPixels;
+  std::vector< SizeValueType > m_NumberOfSkippedPixels;
+  std::vector< SizeValueType > m_NumberOfEvaluatedPixels;
+
+  // the scale being computed by GenerateData
+  unsigned int m_CurrentScaleIndex;
+
+  typename HessianFilter::Pointer m_HessianFilter;
+
 };
 
 }
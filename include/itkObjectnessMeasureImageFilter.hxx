@@ -19,85 +19,493 @@
 #define itkObjectnessMeasureImageFilter_hxx
 
 #include "itkObjectnessMeasureImageFilter.h"
-#include "itkHessianImageFilter.h"
-#include "itkHessianToObjectnessMeasureImageFilter.h"
-#include "itkProgressAccumulator.h"
+
+#include "itkImageScanlineConstIterator.h"
+
+#include <algorithm>
+#include <cmath>
 
 
 namespace itk
 {
 
-template< typename TInputImage, typename TOutputImage >
-ObjectnessMeasureImageFilter< TInputImage,TOutputImage >
+template< typename TInputImage, typename TOutputImage, typename TInternalType >
+ObjectnessMeasureImageFilter< TInputImage,TOutputImage,TInternalType >
 ::ObjectnessMeasureImageFilter() :
   m_Alpha( 0.5 ),
   m_Beta( 0.5 ),
   m_Gamma( 5.0 ),
   m_ObjectDimension( 1 ),
   m_BrightObject( true ),
-  m_ScaleObjectnessMeasure( true )
+  m_ScaleObjectnessMeasure( true ),
+  m_Sigma( 0.0 ),
+  m_SigmaMinimum( 1.0 ),
+  m_SigmaMaximum( 4.0 ),
+  m_NumberOfSigmaSteps( 0 ),
+  m_GenerateScalesOutput( false ),
+  m_HessianNormThreshold( 0.0 ),
+  m_FractionOfSkippedPixels( 0.0 ),
+  m_CurrentScaleIndex( 0 )
 {
+  m_HessianFilter = HessianFilter::New();
+
+  this->ProcessObject::SetNumberOfRequiredOutputs( 2 );
+  this->ProcessObject::SetNthOutput( 1, this->MakeOutput( 1 ) );
 }
 
-template< typename TInputImage, typename TOutputImage >
-ObjectnessMeasureImageFilter< TInputImage,TOutputImage >
-::~ObjectnessMeasureImageFilter()
+template< typename TInputImage, typename TOutputImage, typename TInternalType >
+DataObject::Pointer
+ObjectnessMeasureImageFilter< TInputImage,TOutputImage,TInternalType >
+::MakeOutput( DataObjectPointerArraySizeType idx )
+{
+  if ( idx == 1 )
+    {
+    return ScalesImageType::New().GetPointer();
+    }
+  return Superclass::MakeOutput( idx );
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalType >
+void
+ObjectnessMeasureImageFilter< TInputImage,TOutputImage,TInternalType >
+::SetMaskImage( const MaskImageType *mask )
+{
+  this->ProcessObject::SetNthInput( 1, const_cast< MaskImageType * >( mask ) );
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalType >
+const typename ObjectnessMeasureImageFilter< TInputImage,TOutputImage,TInternalType >::MaskImageType *
+ObjectnessMeasureImageFilter< TInputImage,TOutputImage,TInternalType >
+::GetMaskImage() const
 {
+  return static_cast< const MaskImageType * >( this->ProcessObject::GetInput( 1 ) );
 }
 
+template< typename TInputImage, typename TOutputImage, typename TInternalType >
+const typename ObjectnessMeasureImageFilter< TInputImage,TOutputImage,TInternalType >::ScalesImageType *
+ObjectnessMeasureImageFilter< TInputImage,TOutputImage,TInternalType >
+::GetScalesOutput() const
+{
+  return static_cast< const ScalesImageType * >( this->ProcessObject::GetOutput( 1 ) );
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalType >
+double
+ObjectnessMeasureImageFilter< TInputImage,TOutputImage,TInternalType >
+::ComputeSigma( unsigned int scaleIndex ) const
+{
+  if ( m_NumberOfSigmaSteps == 0 )
+    {
+    return m_Sigma;
+    }
+  if ( m_NumberOfSigmaSteps == 1 || scaleIndex == 0 )
+    {
+    return m_SigmaMinimum;
+    }
+  if ( scaleIndex + 1 >= m_NumberOfSigmaSteps )
+    {
+    return m_SigmaMaximum;
+    }
+
+  const double t = static_cast< double >( scaleIndex ) / ( m_NumberOfSigmaSteps - 1 );
+  if ( m_SigmaMinimum > 0.0 && m_SigmaMaximum > 0.0 )
+    {
+    return std::exp( std::log( m_SigmaMinimum ) + t * ( std::log( m_SigmaMaximum ) - std::log( m_SigmaMinimum ) ) );
+    }
+  return m_SigmaMinimum + t * ( m_SigmaMaximum - m_SigmaMinimum );
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalType >
+void
+ObjectnessMeasureImageFilter< TInputImage,TOutputImage,TInternalType >
+::GenerateInputRequestedRegion()
+{
+  // the output requested region for the input and the mask
+  Superclass::GenerateInputRequestedRegion();
+
+  if ( !this->GetInput() )
+    {
+    return;
+    }
 
-template< typename TInputImage, typename TOutputImage >
+  // pad the input requested region by the radius of the Hessian of
+  // the largest scale
+  double maximumSigma = m_Sigma;
+  if ( m_NumberOfSigmaSteps > 0 )
+    {
+    maximumSigma = std::max( m_SigmaMinimum, m_SigmaMaximum );
+    }
+
+  m_HessianFilter->SetInput( this->GetInput() );
+  m_HessianFilter->GetOutput()->SetRequestedRegion( this->GetOutput()->GetRequestedRegion() );
+  m_HessianFilter->SetSigmaForScale( maximumSigma );
+  m_HessianFilter->GenerateInputRequestedRegion();
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalType >
 void
-ObjectnessMeasureImageFilter< TInputImage,TOutputImage >
-::EnlargeOutputRequestedRegion(DataObject *output)
+ObjectnessMeasureImageFilter< TInputImage,TOutputImage,TInternalType >
+::AllocateOutputs()
 {
-  output->SetRequestedRegionToLargestPossibleRegion();
+  OutputImageType *output = this->GetOutput();
+  output->SetBufferedRegion( output->GetRequestedRegion() );
+  output->Allocate();
+
+  if ( m_GenerateScalesOutput )
+    {
+    ScalesImageType *scales = static_cast< ScalesImageType * >( this->ProcessObject::GetOutput( 1 ) );
+    scales->SetBufferedRegion( scales->GetRequestedRegion() );
+    scales->Allocate();
+    }
 }
 
-template< typename TInputImage, typename TOutputImage >
+template< typename TInputImage, typename TOutputImage, typename TInternalType >
 void
-ObjectnessMeasureImageFilter< TInputImage,TOutputImage >
+ObjectnessMeasureImageFilter< TInputImage,TOutputImage,TInternalType >
 ::GenerateData()
 {
-// Create a process accumulator for tracking the progress of this minipipeline
-  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
-  progress->SetMiniPipelineFilter( this );
+  this->AllocateOutputs();
+
+  const unsigned int numberOfScales = std::max( m_NumberOfSigmaSteps, 1u );
+
+  m_NumberOfSkippedPixels.assign( this->GetNumberOfThreads(), 0 );
+  m_NumberOfEvaluatedPixels.assign( this->GetNumberOfThreads(), 0 );
+
+  // the Hessian filter computes into the output's buffer
+  m_HessianFilter->SetInput( this->GetInput() );
+  m_HessianFilter->GraftOutput( this->GetOutput() );
+
+  try
+    {
+    for ( m_CurrentScaleIndex = 0; m_CurrentScaleIndex < numberOfScales; ++m_CurrentScaleIndex )
+      {
+      m_HessianFilter->SetSigmaForScale( this->ComputeSigma( m_CurrentScaleIndex ) );
+
+      this->BeforeThreadedGenerateData();
+
+      typename Superclass::ThreadStruct str;
+      str.Filter = this;
+
+      this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
+      this->GetMultiThreader()->SetSingleMethod( this->ThreaderCallback, &str );
+      this->GetMultiThreader()->SingleMethodExecute();
+      }
+    }
+  catch ( ... )
+    {
+    m_HessianFilter->GetOutput()->ReleaseData();
+    throw;
+    }
+  m_HessianFilter->GetOutput()->ReleaseData();
+
+  this->AfterThreadedGenerateData();
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalType >
+void
+ObjectnessMeasureImageFilter< TInputImage,TOutputImage,TInternalType >
+::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  if ( m_ObjectDimension >= ImageDimension )
+    {
+    itkExceptionMacro( "ObjectDimension must be lower than ImageDimension." );
+    }
+
+  // a sigma of 0 normalizes the Hessian of the scale to 0
+  if ( m_NumberOfSigmaSteps > 0
+       && ( m_SigmaMinimum <= 0.0 || ( m_NumberOfSigmaSteps > 1 && m_SigmaMaximum <= 0.0 ) ) )
+    {
+    itkExceptionMacro( "SigmaMinimum and SigmaMaximum must be greater than 0 in the multiscale mode." );
+    }
+
+  m_HessianFilter->BeforeThreadedGenerateData();
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalType >
+void
+ObjectnessMeasureImageFilter< TInputImage,TOutputImage,TInternalType >
+::AfterThreadedGenerateData()
+{
+  Superclass::AfterThreadedGenerateData();
+
+  SizeValueType numberOfSkippedPixels = 0;
+  SizeValueType numberOfEvaluatedPixels = 0;
+  for ( size_t i = 0; i < m_NumberOfSkippedPixels.size(); ++i )
+    {
+    numberOfSkippedPixels += m_NumberOfSkippedPixels[i];
+    numberOfEvaluatedPixels += m_NumberOfEvaluatedPixels[i];
+    }
+
+  m_FractionOfSkippedPixels = ( numberOfEvaluatedPixels > 0 )
+    ? static_cast< double >( numberOfSkippedPixels ) / numberOfEvaluatedPixels : 0.0;
+
+  itkDebugMacro( << "Skipped " << 100.0 * m_FractionOfSkippedPixels << "% of the pixels below the HessianNormThreshold" );
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalType >
+ObjectnessMeasureImageFilter< TInputImage,TOutputImage,TInternalType >
+::~ObjectnessMeasureImageFilter()
+{
+}
+
+
+template< typename TInputImage, typename TOutputImage, typename TInternalType >
+void
+ObjectnessMeasureImageFilter< TInputImage,TOutputImage,TInternalType >
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                       ThreadIdType threadId)
+{
+  OutputImageType *output = this->GetOutput();
+  ScalesPixelType *scalesBuffer = ITK_NULLPTR;
+  if ( m_GenerateScalesOutput )
+    {
+    scalesBuffer = static_cast< ScalesImageType * >( this->ProcessObject::GetOutput( 1 ) )->GetBufferPointer();
+    }
+
+  // normalize the Hessian across scales in the multiscale mode
+  const double       sigma = m_HessianFilter->GetSigma();
+  const InternalType hessianScale = ( m_NumberOfSigmaSteps > 0 ) ? sigma * sigma : 1.0;
+
+  ObjectnessScanlineWriter writer( this,
+                                   hessianScale,
+                                   m_CurrentScaleIndex > 0,
+                                   output->GetBufferPointer(),
+                                   scalesBuffer,
+                                   static_cast< ScalesPixelType >( sigma ) );
+
+  // each scale is an equal part of the progress of the update
+  const unsigned int numberOfScales = std::max( m_NumberOfSigmaSteps, 1u );
+  const float        progressWeight = 1.0f / numberOfScales;
+  ProgressReporter   progress( this, threadId, outputRegionForThread.GetNumberOfPixels(), 100,
+                               m_CurrentScaleIndex * progressWeight, progressWeight );
+
+  const MaskImageType *mask = this->GetMaskImage();
+  if ( mask == ITK_NULLPTR )
+    {
+    m_HessianFilter->ComputeHessianRegion( outputRegionForThread, writer, progress );
+    }
+  else
+    {
+    this->ThreadedComputeHessianInMask( outputRegionForThread, mask, scalesBuffer, writer, progress );
+    }
+
+  m_NumberOfSkippedPixels[threadId] += writer.GetNumberOfSkippedPixels();
+  m_NumberOfEvaluatedPixels[threadId] += writer.GetNumberOfEvaluatedPixels();
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalType >
+void
+ObjectnessMeasureImageFilter< TInputImage,TOutputImage,TInternalType >
+::ThreadedComputeHessianInMask( const OutputImageRegionType& outputRegionForThread,
+                                const MaskImageType *mask,
+                                ScalesPixelType *scalesBuffer,
+                                ObjectnessScanlineWriter &writer,
+                                ProgressReporter &progress )
+{
+  OutputImageType *output = this->GetOutput();
+  OutputPixelType *outputBuffer = output->GetBufferPointer();
+
+  // the unmasked pixels are set once, later scales keep the 0
+  const bool clear = ( m_CurrentScaleIndex == 0 );
+
+  OutputImageRegionType run = outputRegionForThread;
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+    run.SetSize( i, 1 );
+    }
+
+  // the boundary faces and the smoothing buffers are shared by the runs
+  typename HessianFilter::ThreadBuffers buffers;
+  m_HessianFilter->InitializeThreadBuffers( outputRegionForThread, buffers );
+
+  ImageScanlineConstIterator< MaskImageType > maskIt( mask, outputRegionForThread );
+  while ( !maskIt.IsAtEnd() )
+    {
+    OffsetValueType offset = output->ComputeOffset( maskIt.GetIndex() );
+    while ( !maskIt.IsAtEndOfLine() )
+      {
+      if ( maskIt.Get() == NumericTraits< MaskPixelType >::ZeroValue() )
+        {
+        if ( clear )
+          {
+          outputBuffer[offset] = NumericTraits< OutputPixelType >::ZeroValue();
+          if ( scalesBuffer )
+            {
+            scalesBuffer[offset] = NumericTraits< ScalesPixelType >::ZeroValue();
+            }
+          }
+        progress.CompletedPixel();
+        ++maskIt;
+        ++offset;
+        continue;
+        }
 
-  typename InputImageType::Pointer localInput = InputImageType::New();
-  localInput->Graft( this->GetInput() );
+      // compute the run of masked pixels starting here
+      run.SetIndex( maskIt.GetIndex() );
+      SizeValueType length = 0;
+      while ( !maskIt.IsAtEndOfLine() && maskIt.Get() != NumericTraits< MaskPixelType >::ZeroValue() )
+        {
+        ++length;
+        ++maskIt;
+        }
+      offset += length;
+      run.SetSize( 0, length );
 
-  typedef HessianImageFilter<InputImageType>          HessianFilterType;
-  typedef typename HessianFilterType::OutputImageType HessianImageType;
+      m_HessianFilter->ComputeHessianRegion( run, writer, progress, buffers );
+      }
+    maskIt.NextLine();
+    }
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalType >
+void
+ObjectnessMeasureImageFilter< TInputImage,TOutputImage,TInternalType >
+::ComputeEigenValues( const TensorType *tensors, EigenValueArrayType *eigenValues, SizeValueType length,
+                      const DispatchBase & )
+{
+  for ( SizeValueType x = 0; x < length; ++x )
+    {
+    tensors[x].ComputeEigenValues( eigenValues[x] );
+    }
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalType >
+void
+ObjectnessMeasureImageFilter< TInputImage,TOutputImage,TInternalType >
+::ComputeEigenValues( const TensorType *tensors, EigenValueArrayType *eigenValues, SizeValueType length,
+                      const Dispatch<2> & )
+{
+  SymmetricEigenValuesClosedForm< InternalType, 2 >::ComputeEigenValues( tensors[0].GetDataPointer(),
+                                                                         eigenValues[0].GetDataPointer(),
+                                                                         length );
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalType >
+void
+ObjectnessMeasureImageFilter< TInputImage,TOutputImage,TInternalType >
+::ComputeEigenValues( const TensorType *tensors, EigenValueArrayType *eigenValues, SizeValueType length,
+                      const Dispatch<3> & )
+{
+  SymmetricEigenValuesClosedForm< InternalType, 3 >::ComputeEigenValues( tensors[0].GetDataPointer(),
+                                                                         eigenValues[0].GetDataPointer(),
+                                                                         length );
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalType >
+typename ObjectnessMeasureImageFilter< TInputImage,TOutputImage,TInternalType >::InternalType
+ObjectnessMeasureImageFilter< TInputImage,TOutputImage,TInternalType >
+::ComputeObjectness( const EigenValueArrayType &eigenValues ) const
+{
+  // Sort the eigenvalues by magnitude but retain their sign.
+  // The eigenvalues are to be sorted |e1|<=|e2|<=...<=|eN|, with
+  // equal magnitudes ordered as by the insertion sort of
+  // HessianToObjectnessMeasureImageFilter
+  EigenValueArrayType sortedEigenValues = eigenValues;
+  for ( unsigned int i = 1; i < ImageDimension; ++i )
+    {
+    const InternalType v = sortedEigenValues[i];
+    unsigned int       j = i;
+    for ( ; j > 0 && std::abs( v ) <= std::abs( sortedEigenValues[j-1] ); --j )
+      {
+      sortedEigenValues[j] = sortedEigenValues[j-1];
+      }
+    sortedEigenValues[j] = v;
+    }
 
-  typename HessianFilterType::Pointer hessianFilter = HessianFilterType::New();
+  // Check whether eigenvalues have the right sign
+  for ( unsigned int i = m_ObjectDimension; i < ImageDimension; ++i )
+    {
+    if ( ( m_BrightObject && sortedEigenValues[i] > 0.0 )
+         || ( !m_BrightObject && sortedEigenValues[i] < 0.0 ) )
+      {
+      return NumericTraits< InternalType >::ZeroValue();
+      }
+    }
 
-  hessianFilter->SetInput( localInput );
+  EigenValueArrayType sortedAbsEigenValues;
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+    sortedAbsEigenValues[i] = std::abs( sortedEigenValues[i] );
+    }
 
-  typedef HessianToObjectnessMeasureImageFilter< HessianImageType, OutputImageType > ObjectnessFilterType;
+  // the constants have the InternalType so a float objectness is
+  // computed in float
+  const InternalType one = 1.0;
+  const InternalType half = 0.5;
 
-  typename ObjectnessFilterType::Pointer objectnessFilter = ObjectnessFilterType::New();
+  InternalType objectnessMeasure = 1.0;
 
-  objectnessFilter->SetInput( hessianFilter->GetOutput() );
+  // Compute objectness from eigenvalue ratios and second-order structureness
+  if ( m_ObjectDimension < ImageDimension - 1 )
+    {
+    InternalType rA = sortedAbsEigenValues[m_ObjectDimension];
+    InternalType rADenominatorBase = 1.0;
+    for ( unsigned int j = m_ObjectDimension + 1; j < ImageDimension; ++j )
+      {
+      rADenominatorBase *= sortedAbsEigenValues[j];
+      }
+    if ( std::abs( rADenominatorBase ) > 0.0 )
+      {
+      if ( std::abs( m_Alpha ) > 0.0 )
+        {
+        const InternalType exponent = 1.0 / ( ImageDimension - m_ObjectDimension - 1 );
+        const InternalType alpha = m_Alpha;
+        rA /= std::pow( rADenominatorBase, exponent );
+        objectnessMeasure *= one - std::exp( -half * rA * rA / ( alpha * alpha ) );
+        }
+      }
+    else
+      {
+      objectnessMeasure = 0.0;
+      }
+    }
 
-  objectnessFilter->SetAlpha( m_Alpha );
-  objectnessFilter->SetBeta( m_Beta );
-  objectnessFilter->SetGamma( m_Gamma );
-  objectnessFilter->SetScaleObjectnessMeasure( m_ScaleObjectnessMeasure );
-  objectnessFilter->SetObjectDimension( m_ObjectDimension );
-  objectnessFilter->SetBrightObject( m_BrightObject);
+  if ( m_ObjectDimension > 0 )
+    {
+    InternalType rB = sortedAbsEigenValues[m_ObjectDimension - 1];
+    InternalType rBDenominatorBase = 1.0;
+    for ( unsigned int j = m_ObjectDimension; j < ImageDimension; ++j )
+      {
+      rBDenominatorBase *= sortedAbsEigenValues[j];
+      }
+    if ( std::abs( rBDenominatorBase ) > 0.0 && std::abs( m_Beta ) > 0.0 )
+      {
+      const InternalType exponent = 1.0 / ( ImageDimension - m_ObjectDimension );
+      const InternalType beta = m_Beta;
+      rB /= std::pow( rBDenominatorBase, exponent );
+      objectnessMeasure *= std::exp( -half * rB * rB / ( beta * beta ) );
+      }
+    else
+      {
+      objectnessMeasure = 0.0;
+      }
+    }
 
-  progress->RegisterInternalFilter( hessianFilter, 0.5f );
-  progress->RegisterInternalFilter( objectnessFilter, 0.5f );
+  if ( std::abs( m_Gamma ) > 0.0 )
+    {
+    InternalType frobeniusNormSquared = 0.0;
+    for ( unsigned int i = 0; i < ImageDimension; ++i )
+      {
+      frobeniusNormSquared += sortedAbsEigenValues[i] * sortedAbsEigenValues[i];
+      }
+    const InternalType gamma = m_Gamma;
+    objectnessMeasure *= one - std::exp( -half * frobeniusNormSquared / ( gamma * gamma ) );
+    }
 
+  // Rescale the objectness measure by the magnitude of the largest eigenvalue
+  if ( m_ScaleObjectnessMeasure )
+    {
+    objectnessMeasure *= sortedAbsEigenValues[ImageDimension - 1];
+    }
 
-  objectnessFilter->GraftOutput( this->GetOutput() );
-  objectnessFilter->Update();
-  this->GraftOutput(objectnessFilter->GetOutput());
+  return objectnessMeasure;
 }
 
-template< typename TInputImage, typename TOutputImage >
+template< typename TInputImage, typename TOutputImage, typename TInternalType >
 void
-ObjectnessMeasureImageFilter< TInputImage,TOutputImage >
+ObjectnessMeasureImageFilter< TInputImage,TOutputImage,TInternalType >
 ::PrintSelf(std::ostream & os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
@@ -108,6 +516,13 @@ ObjectnessMeasureImageFilter< TInputImage,TOutputImage >
   os << indent << "ScaleObjectnessMeasure: " << m_ScaleObjectnessMeasure << std::endl;
   os << indent << "ObjectDimension: " << m_ObjectDimension << std::endl;
   os << indent << "BrightObject: " << m_BrightObject << std::endl;
+  os << indent << "Sigma: " << m_Sigma << std::endl;
+  os << indent << "SigmaMinimum: " << m_SigmaMinimum << std::endl;
+  os << indent << "SigmaMaximum: " << m_SigmaMaximum << std::endl;
+  os << indent << "NumberOfSigmaSteps: " << m_NumberOfSigmaSteps << std::endl;
+  os << indent << "GenerateScalesOutput: " << m_GenerateScalesOutput << std::endl;
+  os << indent << "HessianNormThreshold: " << m_HessianNormThreshold << std::endl;
+  os << indent << "FractionOfSkippedPixels: " << m_FractionOfSkippedPixels << std::endl;
 }
 
 }
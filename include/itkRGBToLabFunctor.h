@@ -0,0 +1,109 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkRGBToLabFunctor_h
+#define itkRGBToLabFunctor_h
+
+#include <cmath>
+#include <itkNumericTraits.h>
+
+namespace itk
+{
+namespace Functor
+{
+/**
+ * \class RGBToLab
+ * \brief Converts a sRGB pixel to the CIE L*a*b* color space.
+ *
+ * The first three components of the input are interpreted as sRGB
+ * with a D65 white point. Integer components are normalized by the
+ * maximum value of the component type, while floating point
+ * components are expected to be in the range [0,1].
+ *
+ * The output is the L*, a* and b* components, with L* in the range
+ * [0,100].
+ *
+ * \ingroup SimpleITKFiltersModule
+ */
+template< class TInput, class TOutput >
+class RGBToLab
+{
+public:
+  // Use default copy, assigned and destructor
+  // RGBToLab() {} default constructor OK
+
+  typedef typename NumericTraits<TInput>::ValueType  InputComponentType;
+  typedef typename NumericTraits<TOutput>::ValueType OutputComponentType;
+
+  bool operator!=(const RGBToLab &) const
+    {
+      return false;
+    }
+
+  bool operator==(const RGBToLab & other) const
+    {
+      return !( *this != other );
+    }
+
+  inline TOutput operator()(const TInput & A) const
+    {
+      const double scale = NumericTraits<InputComponentType>::is_integer ?
+        1.0 / static_cast<double>( NumericTraits<InputComponentType>::max() ) : 1.0;
+
+      const double r = Linearize( scale * static_cast<double>( A[0] ) );
+      const double g = Linearize( scale * static_cast<double>( A[1] ) );
+      const double b = Linearize( scale * static_cast<double>( A[2] ) );
+
+      // sRGB to CIE XYZ normalized by the D65 reference white
+      const double fx = F( ( 0.4124564*r + 0.3575761*g + 0.1804375*b ) / 0.95047 );
+      const double fy = F( ( 0.2126729*r + 0.7151522*g + 0.0721750*b ) );
+      const double fz = F( ( 0.0193339*r + 0.1191920*g + 0.9503041*b ) / 1.08883 );
+
+      TOutput lab;
+      lab[0] = static_cast<OutputComponentType>( 116.0*fy - 16.0 );
+      lab[1] = static_cast<OutputComponentType>( 500.0*( fx - fy ) );
+      lab[2] = static_cast<OutputComponentType>( 200.0*( fy - fz ) );
+      return lab;
+    }
+
+private:
+
+  /** Inverse sRGB companding */
+  static inline double Linearize( double c )
+    {
+      if ( c <= 0.04045 )
+        {
+        return c / 12.92;
+        }
+      return std::pow( ( c + 0.055 ) / 1.055, 2.4 );
+    }
+
+  static inline double F( double t )
+    {
+      // (6/29)^3
+      if ( t > 0.008856451679035631 )
+        {
+        return std::pow( t, 1.0/3.0 );
+        }
+      // t/(3*(6/29)^2) + 4/29
+      return t * 7.787037037037037 + 0.13793103448275862;
+    }
+};
+}
+}
+
+#endif // itkRGBToLabFunctor_h
@@ -20,6 +20,8 @@
 
 #include "itkImageToImageFilter.h"
 #include "itkIsSame.h"
+#include "itkNumericTraitsFixedArrayPixel.h"
+#include "itkRGBToLabFunctor.h"
 
 #include "itkBarrier.h"
 
@@ -43,6 +45,10 @@ namespace itk
  * m-component images. The filter works with VectorImage, scalar
  * Images, and Images of FixedArrays.
  *
+ * When ConvertRGBToLab is enabled, a 3-component sRGB input is
+ * converted to CIE L*a*b* by the filter, so that a separate color
+ * conversion filter is not needed before clustering.
+ *
  * R. Achanta, A. Shaji, K. Smith, and A. Lucchi. Slic superpixels. Technical report, 2010.
  *
  * \ingroup SimpleITKFiltersModule
@@ -86,6 +92,10 @@ public:
 
   typedef FixedArray< unsigned int, ImageDimension > SuperGridSizeType;
 
+  /** Type of the internal image used when ConvertRGBToLab is enabled. */
+  typedef FixedArray<float, 3>                LabPixelType;
+  typedef Image<LabPixelType, ImageDimension> LabImageType;
+
   /** \brief Weighting coefficient for the spatial distance
    *
    * The default value is 10. This default is useful for the CIE
@@ -140,6 +150,20 @@ public:
   itkGetMacro(LabelConnectivityRelabelSequential, bool);
   itkBooleanMacro(LabelConnectivityRelabelSequential);
 
+  /** \brief Convert a sRGB input to CIE L*a*b* before clustering.
+   *
+   * False by default.
+   *
+   * The input must have 3 components. Integer components are
+   * normalized by the maximum of the component type, while floating
+   * point components are expected in [0,1]. The converted pixels are
+   * computed once by the threads of this filter into a compact
+   * internal buffer, which is released when the filter completes.
+   */
+  itkSetMacro(ConvertRGBToLab, bool);
+  itkGetConstMacro(ConvertRGBToLab, bool);
+  itkBooleanMacro(ConvertRGBToLab);
+
 protected:
   SLICImageFilter();
   ~SLICImageFilter();
@@ -153,11 +177,16 @@ protected:
 
   void BeforeThreadedGenerateData() ITK_OVERRIDE;
 
-  void ThreadedUpdateDistanceAndLabel(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId);
+  template<typename TImage>
+  void ThreadedUpdateDistanceAndLabel(const TImage *inputImage, const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId);
 
-  void ThreadedUpdateClusters(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId);
+  template<typename TImage>
+  void ThreadedUpdateClusters(const TImage *inputImage, const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId);
 
-  void ThreadedPerturbClusters(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId);
+  template<typename TImage>
+  void ThreadedPerturbClusters(const TImage *inputImage, const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId);
+
+  void ThreadedConvertToLab(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId);
 
   void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId) ITK_OVERRIDE;
 
@@ -171,25 +200,41 @@ protected:
   DistanceType Distance(const ClusterType &cluster1,
                                const ClusterType &cluster2);
 
+  template<typename TPixelType>
   inline DistanceType Distance(const ClusterType &cluster,
-                        const InputPixelType &v,
+                        const TPixelType &v,
                         const IndexType &idx)
     {
       return Self::DistanceDispatched(cluster, v, idx);
     }
 
-  inline static void CreateClusterPoint( const InputPixelType &v,
+  template<typename TPixelType>
+  inline static void CreateClusterPoint( const TPixelType &v,
                                          ClusterType &outCluster,
                                          const unsigned int numberOfComponents,
                                          const IndexType &idx )
     {
-      NumericTraits<InputPixelType>::AssignToArray(v, outCluster);
+      NumericTraits<TPixelType>::AssignToArray(v, outCluster);
       for(unsigned int i = 0; i < ImageDimension; ++i)
         {
         outCluster[numberOfComponents+i] = idx[i];
         }
     }
 
+  template<typename TPixelType>
+  inline static LabPixelType ConvertToLab( const TPixelType &v )
+    {
+      typedef typename NumericTraits<TPixelType>::ValueType ComponentType;
+      typedef FixedArray<ComponentType, 3>                  RGBType;
+
+      // scalar and multi-component pixels are copied into a 3-vector,
+      // the number of components is checked in VerifyInputInformation
+      RGBType rgb;
+      rgb.Fill( NumericTraits<ComponentType>::ZeroValue() );
+      NumericTraits<TPixelType>::AssignToArray(v, rgb);
+      return Functor::RGBToLab<RGBType, LabPixelType>()(rgb);
+    }
+
 private:
   SLICImageFilter(const Self &);    //purposely not implemented
   void operator=(const Self &);     //purposely not implemented
@@ -249,6 +294,7 @@ private:
   bool              m_LabelConnectivityEnforce;
   float             m_LabelConnectivityMinimumSize;
   bool              m_LabelConnectivityRelabelSequential;
+  bool              m_ConvertRGBToLab;
 
   FixedArray<double,ImageDimension> m_DistanceScales;
   std::vector<ClusterComponentType> m_Clusters;
@@ -271,6 +317,7 @@ private:
   typename Barrier::Pointer           m_Barrier;
   typename DistanceImageType::Pointer m_DistanceImage;
   typename MarkerImageType::Pointer   m_MarkerImage;
+  typename LabImageType::Pointer      m_LabImage;
 };
 } // end namespace itk
 
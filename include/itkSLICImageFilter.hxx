@@ -38,6 +38,7 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
     m_LabelConnectivityEnforce(true),
     m_LabelConnectivityMinimumSize(0.25),
     m_LabelConnectivityRelabelSequential(false),
+    m_ConvertRGBToLab(false),
     m_NumberOfThreadsUsed(1),
     m_Barrier(Barrier::New())
 {
@@ -97,6 +98,7 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
   os << indent << "LabelConnectivityEnforce: " << m_LabelConnectivityEnforce << std::endl;
   os << indent << "LabelConnectivityMinimumSize: " << m_LabelConnectivityMinimumSize << std::endl;
   os << indent << "LabelConnectivityRelabelSequential: " << m_LabelConnectivityRelabelSequential << std::endl;
+  os << indent << "ConvertRGBToLab: " << m_ConvertRGBToLab << std::endl;
 }
 
 template<typename TInputImage, typename TOutputImage, typename TDistancePixel>
@@ -122,6 +124,12 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
     itkExceptionMacro( "Too many clusters for output pixel type!" );
     }
 
+  if ( m_ConvertRGBToLab && inputImage->GetNumberOfComponentsPerPixel() != 3 )
+    {
+    itkExceptionMacro( "ConvertRGBToLab requires an input with 3 components, not "
+                       << inputImage->GetNumberOfComponentsPerPixel() << "!" );
+    }
+
 }
 
 template<typename TInputImage, typename TOutputImage, typename TDistancePixel>
@@ -219,10 +227,20 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
       RefClusterType cluster( numberOfClusterComponents, &m_Clusters[cnt*numberOfClusterComponents] );
       ++cnt;
 
-      CreateClusterPoint(inputImage->GetPixel(idx),
-                         cluster,
-                         numberOfComponents,
-                         idx );
+      if ( m_ConvertRGBToLab )
+        {
+        CreateClusterPoint(ConvertToLab(inputImage->GetPixel(idx)),
+                           cluster,
+                           numberOfComponents,
+                           idx );
+        }
+      else
+        {
+        CreateClusterPoint(inputImage->GetPixel(idx),
+                           cluster,
+                           numberOfComponents,
+                           idx );
+        }
       itkDebugMacro("Initial cluster " << cnt-1 << " : " << cluster << " idx: " << idx );
       accErr[0] += totalErr[0];
       idx[0] += m_SuperGridSize[0] + accErr[0]/strips[0];
@@ -232,10 +250,20 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
       RefClusterType cluster( numberOfClusterComponents, &m_Clusters[cnt*numberOfClusterComponents] );
       ++cnt;
 
-      CreateClusterPoint(inputImage->GetPixel(idx),
-                         cluster,
-                         numberOfComponents,
-                         idx );
+      if ( m_ConvertRGBToLab )
+        {
+        CreateClusterPoint(ConvertToLab(inputImage->GetPixel(idx)),
+                           cluster,
+                           numberOfComponents,
+                           idx );
+        }
+      else
+        {
+        CreateClusterPoint(inputImage->GetPixel(idx),
+                           cluster,
+                           numberOfComponents,
+                           idx );
+        }
       itkDebugMacro("Initial cluster " << cnt-1<< " : " << cluster );
 
     // increment the startIdx to next line on sample grid
@@ -268,6 +296,15 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
 
   m_MarkerImage = ITK_NULLPTR;
 
+  m_LabImage = ITK_NULLPTR;
+  if ( m_ConvertRGBToLab )
+    {
+    m_LabImage = LabImageType::New();
+    m_LabImage->CopyInformation(inputImage);
+    m_LabImage->SetBufferedRegion( region );
+    m_LabImage->Allocate();
+    }
+
   for (unsigned int i = 0; i < ImageDimension; ++i)
     {
     const double physicalGridSize = m_SuperGridSize[i];
@@ -283,9 +320,12 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
 
 
 template<typename TInputImage, typename TOutputImage, typename TDistancePixel>
+template<typename TImage>
 void
 SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
-::ThreadedUpdateDistanceAndLabel(const OutputImageRegionType & outputRegionForThread, ThreadIdType  itkNotUsed(threadId))
+::ThreadedUpdateDistanceAndLabel(const TImage *inputImage,
+                                 const OutputImageRegionType & outputRegionForThread,
+                                 ThreadIdType  itkNotUsed(threadId))
 {
   // This method modifies the OutputImage and the DistanceImage only
   // in the outputRegionForThread. It searches for any cluster, whose
@@ -293,10 +333,9 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
   // updates DistnaceImage with the minimum distance and the
   // corresponding label id in the output image.
   //
-  typedef ImageScanlineConstIterator< InputImageType > InputConstIteratorType;
-  typedef ImageScanlineIterator< DistanceImageType >   DistanceIteratorType;
+  typedef ImageScanlineConstIterator< TImage >       InputConstIteratorType;
+  typedef ImageScanlineIterator< DistanceImageType > DistanceIteratorType;
 
-  const InputImageType *inputImage = this->GetInput();
   OutputImageType *outputImage = this->GetOutput();
   const unsigned int numberOfComponents = inputImage->GetNumberOfComponentsPerPixel();
   const unsigned int numberOfClusterComponents = numberOfComponents+ImageDimension;
@@ -364,18 +403,20 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
 
 
 template<typename TInputImage, typename TOutputImage, typename TDistancePixel>
+template<typename TImage>
 void
 SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
-::ThreadedUpdateClusters(const OutputImageRegionType & updateRegionForThread, ThreadIdType threadId)
+::ThreadedUpdateClusters(const TImage *inputImage,
+                         const OutputImageRegionType & updateRegionForThread,
+                         ThreadIdType threadId)
 {
-  const InputImageType *inputImage = this->GetInput();
   OutputImageType *outputImage = this->GetOutput();
 
   const unsigned int numberOfComponents = inputImage->GetNumberOfComponentsPerPixel();
   const unsigned int numberOfClusterComponents = numberOfComponents+ImageDimension;
 
-  typedef ImageScanlineConstIterator< InputImageType > InputConstIteratorType;
-  typedef ImageScanlineIterator< OutputImageType >     OutputIteratorType;
+  typedef ImageScanlineConstIterator< TImage >     InputConstIteratorType;
+  typedef ImageScanlineIterator< OutputImageType > OutputIteratorType;
 
   UpdateClusterMap &clusterMap = m_UpdateClusterPerThread[threadId];
   clusterMap.clear();
@@ -421,15 +462,18 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
 
 
 template<typename TInputImage, typename TOutputImage, typename TDistancePixel>
+template<typename TImage>
 void
 SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
-::ThreadedPerturbClusters(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId )
+::ThreadedPerturbClusters(const TImage *inputImage,
+                          const OutputImageRegionType & outputRegionForThread,
+                          ThreadIdType threadId )
 {
   // Update the m_Clusters array by spiting the threads over the
   // cluster indexes, moving cluster center to the
   // lowest gradient position in a 1-radius neighborhood.
 
-  const InputImageType *inputImage = this->GetInput();
+  typedef typename TImage::PixelType ImagePixelType;
 
   const unsigned int numberOfComponents = inputImage->GetNumberOfComponentsPerPixel();
   const unsigned int numberOfClusterComponents = numberOfComponents+ImageDimension;
@@ -445,7 +489,7 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
   searchRadius.Fill(1);
 
 
-  typedef ConstNeighborhoodIterator< TInputImage > NeighborhoodType;
+  typedef ConstNeighborhoodIterator< TImage > NeighborhoodType;
 
   // get center and dimension strides for iterator neighborhoods
   NeighborhoodType it( radius, inputImage, outputRegionForThread);
@@ -455,7 +499,7 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
     stride[i] = it.GetStride(i);
     }
 
-  const typename InputImageType::SpacingType spacing = inputImage->GetSpacing();
+  const typename TImage::SpacingType spacing = inputImage->GetSpacing();
 
   // ceiling of number of clusters divided by actual number of threads
   const size_t strideCluster = 1 + ((numberOfClusters - 1) / m_NumberOfThreadsUsed);
@@ -495,8 +539,8 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
       gNorm = 0;
       for ( unsigned int i = 0; i < ImageDimension; i++ )
         {
-        NumericTraits<InputPixelType>::AssignToArray(it.GetPixel(center + stride[i]), A);
-        NumericTraits<InputPixelType>::AssignToArray(it.GetPixel(center - stride[i]), B);
+        NumericTraits<ImagePixelType>::AssignToArray(it.GetPixel(center + stride[i]), A);
+        NumericTraits<ImagePixelType>::AssignToArray(it.GetPixel(center - stride[i]), B);
         A -= B;
         A /= spacing[i]; // omitting constant 2
         gNorm += A.one_norm();
@@ -521,6 +565,31 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
 }
 
 
+template<typename TInputImage, typename TOutputImage, typename TDistancePixel>
+void
+SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
+::ThreadedConvertToLab(const OutputImageRegionType & outputRegionForThread, ThreadIdType itkNotUsed(threadId))
+{
+  typedef ImageScanlineConstIterator< InputImageType > InputConstIteratorType;
+  typedef ImageScanlineIterator< LabImageType >        LabIteratorType;
+
+  InputConstIteratorType itIn(this->GetInput(), outputRegionForThread);
+  LabIteratorType        itLab(m_LabImage, outputRegionForThread);
+
+  while ( !itIn.IsAtEnd() )
+    {
+    while ( !itIn.IsAtEndOfLine() )
+      {
+      itLab.Set( ConvertToLab(itIn.Get()) );
+      ++itIn;
+      ++itLab;
+      }
+    itIn.NextLine();
+    itLab.NextLine();
+    }
+}
+
+
 template<typename TInputImage, typename TOutputImage, typename TDistancePixel>
 void
 SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
@@ -532,8 +601,25 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
   const unsigned int numberOfComponents = inputImage->GetNumberOfComponentsPerPixel();
   const unsigned int numberOfClusterComponents = numberOfComponents+ImageDimension;
 
+  // The converted image is used in place of the input for all
+  // clustering steps
+  const LabImageType *labImage = m_LabImage.GetPointer();
+  if ( labImage )
+    {
+    itkDebugMacro("Converting RGB to Lab");
+    ThreadedConvertToLab(outputRegionForThread,threadId);
+    m_Barrier->Wait();
+    }
+
   itkDebugMacro("Perturb cluster centers");
-  ThreadedPerturbClusters(outputRegionForThread,threadId);
+  if ( labImage )
+    {
+    ThreadedPerturbClusters(labImage,outputRegionForThread,threadId);
+    }
+  else
+    {
+    ThreadedPerturbClusters(inputImage,outputRegionForThread,threadId);
+    }
 
   itkDebugMacro("Entering Main Loop");
   for(unsigned int loopCnt = 0;  loopCnt<m_MaximumNumberOfIterations; ++loopCnt)
@@ -546,12 +632,25 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
       }
     m_Barrier->Wait();
 
-    ThreadedUpdateDistanceAndLabel(outputRegionForThread,threadId);
+    if ( labImage )
+      {
+      ThreadedUpdateDistanceAndLabel(labImage,outputRegionForThread,threadId);
+      }
+    else
+      {
+      ThreadedUpdateDistanceAndLabel(inputImage,outputRegionForThread,threadId);
+      }
 
     m_Barrier->Wait();
 
-
-    ThreadedUpdateClusters(outputRegionForThread, threadId);
+    if ( labImage )
+      {
+      ThreadedUpdateClusters(labImage, outputRegionForThread, threadId);
+      }
+    else
+      {
+      ThreadedUpdateClusters(inputImage, outputRegionForThread, threadId);
+      }
 
     m_Barrier->Wait();
 
@@ -736,6 +835,7 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
   itkDebugMacro("Starting AfterThreadedGenerateData");
 
   m_DistanceImage = ITK_NULLPTR;
+  m_LabImage = ITK_NULLPTR;
 
   const InputImageType *inputImage = this->GetInput();
   OutputImageType      *outputImage = this->GetOutput();
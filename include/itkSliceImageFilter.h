@@ -19,6 +19,9 @@
 #define itkSliceImageFilter_h
 
 #include "itkImageToImageFilter.h"
+#include "itkImage.h"
+#include "itkVectorImage.h"
+#include "itkProgressReporter.h"
 
 namespace itk
 {
@@ -45,6 +48,13 @@ namespace itk
  * cosine matrix is that of the input but with sign changes matching
  * that of the step's sign.
  *
+ * The pixels of Images are copied by scanlines, with the source
+ * offset computed once per output line and a constant stride along
+ * the first dimension. The components of VectorImages are copied
+ * directly between the buffers, without a VariableLengthVector per
+ * pixel. Other image types, such as image adaptors, are copied pixel
+ * by pixel.
+ *
  * \note In certain combination such as with start=1, and step>1 while
  * the physical location of the center of the pixel remains the same,
  * the extent (edge to edge space) of the pixel will beyond the extent
@@ -113,6 +123,38 @@ public:
   itkGetConstReferenceMacro(Step, ArrayType);
   void SetStep( int step);
 
+  /** Set/Get whether the output may be a view of the input.
+   *
+   * When on, the input and output image types are the same and every
+   * step is 1, the output shares the pixel container of the input
+   * instead of copying the pixels. The view is only made when the
+   * input's buffered region, in the output's index space, is the
+   * output's requested region, so the buffered region of the output
+   * never extends beyond its largest possible region. The pixels of
+   * the view change with the input's. Otherwise the output is a
+   * copy. The default is off. */
+  itkSetMacro(AllowView, bool);
+  itkGetConstMacro(AllowView, bool);
+  itkBooleanMacro(AllowView);
+
+  /** Set/Get whether the input is requested slice by slice.
+   *
+   * When on and the step of the last dimension is not -1, 1, only the
+   * input slices of the last dimension used by the output are
+   * requested from the upstream pipeline, one after the other,
+   * instead of their bounding box, so a streaming reader reads only
+   * these slices. After each slice is updated, the threads of the
+   * filter copy it to the output, between one
+   * BeforeThreadedGenerateData and one AfterThreadedGenerateData for
+   * the whole output. The threads are started and joined for every
+   * slice, and the upstream pipeline is updated for every slice, so
+   * this pays off when the skipped slices are expensive to produce,
+   * as when read from disk, not for an input already in memory. The
+   * default is off. */
+  itkSetMacro(SparseInputRequests, bool);
+  itkGetConstMacro(SparseInputRequests, bool);
+  itkBooleanMacro(SparseInputRequests);
+
   /** SliceImageFilter produces an image which is a different
    * resolution and with a different pixel spacing than its input
    * image.
@@ -135,6 +177,10 @@ protected:
   ~SliceImageFilter() {}
   void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
 
+  /** Make the output a view of the input when allowed, else copy the
+   * pixels by the threads */
+  void GenerateData() ITK_OVERRIDE;
+
   /** SliceImageFilter can be implemented as a multithreaded filter.
    * Therefore, this implementation provides a ThreadedGenerateData() routine
    * which is called for each processing thread. The output image data is
@@ -148,15 +194,90 @@ protected:
   void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
                             ThreadIdType threadId) ITK_OVERRIDE;
 
+  /** Copy the output region pixel by pixel with GetPixel, for images
+   * whose buffer is not an array of pixels such as image adaptors */
+  void ThreadedGenerateDataByPixel(const OutputImageRegionType & outputRegionForThread,
+                                   ProgressReporter & progress);
+
+  /** Copy length pixels read with a constant stride in the input
+   * buffer, which may be negative, to consecutive output pixels. A
+   * stride of -1 is copied by blocks read in the forward direction. */
+  template< typename TInputPixel, typename TOutputPixel >
+  static void CopyScanline( const TInputPixel *in,
+                            OffsetValueType stride,
+                            TOutputPixel *out,
+                            SizeValueType length );
+
+  /** The start clamped to the largest possible region of the input */
+  InputIndexType GetClampedStart() const;
+
   void VerifyInputInformation() ITK_OVERRIDE;
 
 private:
   SliceImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);    //purposely not implemented
 
+  /** Copy the output region by scanlines when the input and the
+   * output are Images, pixel by pixel otherwise, reporting the pixels
+   * to the progress of the thread */
+  template< typename TInputPixel, typename TOutputPixel >
+  void DispatchedThreadedGenerateData( const Image< TInputPixel, ImageDimension > *inputPtr,
+                                       Image< TOutputPixel, ImageDimension > *outputPtr,
+                                       const OutputImageRegionType & outputRegionForThread,
+                                       ProgressReporter & progress );
+
+  template< typename TInputPixel, typename TOutputPixel >
+  void DispatchedThreadedGenerateData( const VectorImage< TInputPixel, ImageDimension > *inputPtr,
+                                       VectorImage< TOutputPixel, ImageDimension > *outputPtr,
+                                       const OutputImageRegionType & outputRegionForThread,
+                                       ProgressReporter & progress );
+
+  template< typename TInput, typename TOutput >
+  void DispatchedThreadedGenerateData( const TInput *,
+                                       TOutput *,
+                                       const OutputImageRegionType & outputRegionForThread,
+                                       ProgressReporter & progress )
+    {
+      this->ThreadedGenerateDataByPixel( outputRegionForThread, progress );
+    }
+
+  /** Whether the input slices are requested one by one */
+  bool IsSparseInputRequest() const;
+
+  /** Request each needed slice of the input and copy it to the
+   * output by the threads */
+  void GenerateDataBySlices();
+
+  /** The output slice copied by the threads, and the part of the
+   * progress it reports */
+  struct SliceThreadStruct
+  {
+    Self                 *Filter;
+    OutputImageRegionType Region;
+    float                 InitialProgress;
+    float                 ProgressWeight;
+  };
+
+  /** Copy the part of an output slice of a thread, the slice is split
+   * along its slowest dimension */
+  static ITK_THREAD_RETURN_TYPE SliceThreaderCallback( void *arg );
+
+  /** Share the input's pixel container with the output, only
+   * possible when the input has the type of the output */
+  bool GenerateView( const TOutputImage *inputPtr );
+
+  template< typename TInput >
+  bool GenerateView( const TInput * )
+    {
+      return false;
+    }
+
   IndexType m_Start;
   IndexType m_Stop;
   ArrayType m_Step;
+
+  bool m_AllowView;
+  bool m_SparseInputRequests;
 };
 } // end namespace itk
 
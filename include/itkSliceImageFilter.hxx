@@ -30,9 +30,11 @@
 
 #include "itkSliceImageFilter.h"
 #include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageScanlineIterator.h"
 #include "itkContinuousIndex.h"
 #include "itkObjectFactory.h"
-#include "itkProgressReporter.h"
+
+#include <algorithm>
 
 namespace itk
 {
@@ -41,7 +43,9 @@ namespace itk
  */
 template< class TInputImage, class TOutputImage >
 SliceImageFilter< TInputImage, TOutputImage >
-::SliceImageFilter()
+::SliceImageFilter() :
+  m_AllowView( false ),
+  m_SparseInputRequests( false )
 {
   m_Start.Fill(NumericTraits<IndexValueType>::min());
   m_Stop.Fill(NumericTraits<IndexValueType>::max());
@@ -61,6 +65,8 @@ SliceImageFilter< TInputImage, TOutputImage >
   os << indent << "Start: " << m_Start << std::endl;
   os << indent << "Stop: " << m_Stop << std::endl;
   os << indent << "Step: " << m_Step << std::endl;
+  os << indent << "AllowView: " << m_AllowView << std::endl;
+  os << indent << "SparseInputRequests: " << m_SparseInputRequests << std::endl;
 
 }
 
@@ -134,28 +140,399 @@ SliceImageFilter< TInputImage, TOutputImage >
  *
  */
 template< class TInputImage, class TOutputImage >
-void
+typename SliceImageFilter< TInputImage, TOutputImage >::InputIndexType
 SliceImageFilter< TInputImage, TOutputImage >
-::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
-                       ThreadIdType threadId)
+::GetClampedStart() const
 {
-  // Get the input and output pointers
-  InputImageConstPointer inputPtr = this->GetInput();
-  OutputImagePointer     outputPtr = this->GetOutput();
-
-  // Support progress methods/callbacks
-  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+  const TInputImage *inputPtr = this->GetInput();
 
   const typename TInputImage::SizeType &inputSize = inputPtr->GetLargestPossibleRegion().GetSize();
   const typename TInputImage::IndexType &inputIndex = inputPtr->GetLargestPossibleRegion().GetIndex();
 
-  // clamp start
   InputIndexType start;
   for ( unsigned int i = 0; i < TOutputImage::ImageDimension; i++ )
     {
     start[i] = std::max( m_Start[i], inputIndex[i] );
     start[i] = std::min( start[i], static_cast<IndexValueType>(inputIndex[i] + inputSize[i]-1) );
     }
+  return start;
+}
+
+/**
+ *
+ */
+template< class TInputImage, class TOutputImage >
+void
+SliceImageFilter< TInputImage, TOutputImage >
+::GenerateData()
+{
+  if ( this->IsSparseInputRequest() )
+    {
+    this->GenerateDataBySlices();
+    return;
+    }
+
+  bool view = m_AllowView;
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+    view = view && m_Step[i] == 1;
+    }
+
+  if ( view && this->GenerateView( this->GetInput() ) )
+    {
+    return;
+    }
+
+  // An output which was a view of the input gets its own buffer, so
+  // that the copy does not overwrite the input
+  OutputImageType *outputPtr = this->GetOutput();
+  if ( outputPtr->GetBufferPointer() != ITK_NULLPTR
+       && static_cast< const void * >( outputPtr->GetBufferPointer() ) == static_cast< const void * >( this->GetInput()->GetBufferPointer() ) )
+    {
+    outputPtr->Initialize();
+    }
+
+  Superclass::GenerateData();
+}
+
+/**
+ *
+ */
+template< class TInputImage, class TOutputImage >
+bool
+SliceImageFilter< TInputImage, TOutputImage >
+::IsSparseInputRequest() const
+{
+  const int lastStep = m_Step[ImageDimension - 1];
+  return m_SparseInputRequests && ( lastStep > 1 || lastStep < -1 );
+}
+
+/**
+ *
+ */
+template< class TInputImage, class TOutputImage >
+void
+SliceImageFilter< TInputImage, TOutputImage >
+::GenerateDataBySlices()
+{
+  InputImagePointer  inputPtr = const_cast< TInputImage * >( this->GetInput() );
+  OutputImagePointer outputPtr = this->GetOutput();
+
+  this->AllocateOutputs();
+
+  const unsigned int   lastDim = ImageDimension - 1;
+  const InputIndexType start = this->GetClampedStart();
+
+  // GenerateInputRequestedRegion requested the first slice, the
+  // following have the same extent in the other dimensions
+  typename TInputImage::RegionType inputSliceRegion = inputPtr->GetRequestedRegion();
+
+  SliceThreadStruct str;
+  str.Filter = this;
+  str.Region = outputPtr->GetRequestedRegion();
+
+  const IndexValueType zBegin = str.Region.GetIndex(lastDim);
+  const IndexValueType zEnd = zBegin + static_cast< IndexValueType >( str.Region.GetSize(lastDim) );
+  str.Region.SetSize( lastDim, 1 );
+
+  // a slice has fewer rows to split than the output
+  const SizeValueType rows = ( lastDim > 0 ) ? str.Region.GetSize(lastDim - 1) : 1;
+  const ThreadIdType  numberOfThreads = static_cast< ThreadIdType >(
+    std::max< SizeValueType >( std::min< SizeValueType >( this->GetNumberOfThreads(), rows ), 1 ) );
+
+  // every slice has the same share of the progress
+  str.ProgressWeight = ( zEnd > zBegin ) ? 1.0f / static_cast< float >( zEnd - zBegin ) : 1.0f;
+
+  this->BeforeThreadedGenerateData();
+
+  for ( IndexValueType z = zBegin; z < zEnd; ++z )
+    {
+    inputSliceRegion.SetIndex( lastDim, z * m_Step[lastDim] + start[lastDim] );
+    inputPtr->SetRequestedRegion( inputSliceRegion );
+    inputPtr->PropagateRequestedRegion();
+    inputPtr->UpdateOutputData();
+
+    str.Region.SetIndex( lastDim, z );
+    str.InitialProgress = static_cast< float >( z - zBegin ) * str.ProgressWeight;
+
+    this->GetMultiThreader()->SetNumberOfThreads( numberOfThreads );
+    this->GetMultiThreader()->SetSingleMethod( Self::SliceThreaderCallback, &str );
+    this->GetMultiThreader()->SingleMethodExecute();
+    }
+
+  this->AfterThreadedGenerateData();
+}
+
+/**
+ *
+ */
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+SliceImageFilter< TInputImage, TOutputImage >
+::SliceThreaderCallback( void *arg )
+{
+  const MultiThreader::ThreadInfoStruct *info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  const ThreadIdType threadId = info->ThreadID;
+  const ThreadIdType numberOfThreads = info->NumberOfThreads;
+  SliceThreadStruct *str = static_cast< SliceThreadStruct * >( info->UserData );
+
+  OutputImageRegionType region = str->Region;
+  if ( ImageDimension > 1 )
+    {
+    const unsigned int  splitDim = ImageDimension - 2;
+    const SizeValueType size = region.GetSize(splitDim);
+    const SizeValueType begin = size * threadId / numberOfThreads;
+    const SizeValueType end = size * ( threadId + 1 ) / numberOfThreads;
+
+    region.SetIndex( splitDim, region.GetIndex(splitDim) + static_cast< IndexValueType >( begin ) );
+    region.SetSize( splitDim, end - begin );
+    }
+  else if ( threadId > 0 )
+    {
+    return ITK_THREAD_RETURN_VALUE;
+    }
+
+  if ( region.GetNumberOfPixels() > 0 )
+    {
+    // each slice is its part of the progress of the whole output
+    ProgressReporter progress( str->Filter, threadId, region.GetNumberOfPixels(), 100,
+                               str->InitialProgress, str->ProgressWeight );
+
+    Self *filter = str->Filter;
+    filter->DispatchedThreadedGenerateData( filter->GetInput(), filter->GetOutput(), region, progress );
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+/**
+ *
+ */
+template< class TInputImage, class TOutputImage >
+bool
+SliceImageFilter< TInputImage, TOutputImage >
+::GenerateView( const TOutputImage *inputPtr )
+{
+  OutputImageType *outputPtr = this->GetOutput();
+
+  // With unit steps the output index is the input index minus the
+  // start, the output buffer is the input buffer in this index space.
+  const InputIndexType start = this->GetClampedStart();
+
+  OutputImageRegionType bufferedRegion = inputPtr->GetBufferedRegion();
+  OutputIndexType       bufferedIndex;
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+    bufferedIndex[i] = bufferedRegion.GetIndex(i) - start[i];
+    }
+  bufferedRegion.SetIndex( bufferedIndex );
+
+  // a larger input buffer would give the output pixels outside of
+  // its largest possible region
+  if ( bufferedRegion != outputPtr->GetRequestedRegion() )
+    {
+    return false;
+    }
+
+  outputPtr->SetBufferedRegion( bufferedRegion );
+  outputPtr->SetPixelContainer( const_cast< typename TOutputImage::PixelContainer * >( inputPtr->GetPixelContainer() ) );
+
+  itkDebugMacro( << "Output is a view of the input's buffer " << bufferedRegion );
+  return true;
+}
+
+/**
+ *
+ */
+template< class TInputImage, class TOutputImage >
+void
+SliceImageFilter< TInputImage, TOutputImage >
+::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                       ThreadIdType threadId)
+{
+  // Support progress methods/callbacks
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+
+  this->DispatchedThreadedGenerateData( this->GetInput(), this->GetOutput(), outputRegionForThread, progress );
+}
+
+/**
+ *
+ */
+template< class TInputImage, class TOutputImage >
+template< typename TInputPixel, typename TOutputPixel >
+void
+SliceImageFilter< TInputImage, TOutputImage >
+::CopyScanline( const TInputPixel *in,
+                OffsetValueType stride,
+                TOutputPixel *out,
+                SizeValueType length )
+{
+  if ( stride == 1 )
+    {
+    std::copy( in, in + length, out );
+    return;
+    }
+
+  if ( stride == -1 )
+    {
+    // Reversed line: read blocks forward, so the reads follow the
+    // memory order, and reverse each block in registers
+    const unsigned int BlockSize = 16;
+
+    SizeValueType x = 0;
+    for ( ; x + BlockSize <= length; x += BlockSize )
+      {
+      const TInputPixel *block = in - x - ( BlockSize - 1 );
+
+      TInputPixel buffer[BlockSize];
+      for ( unsigned int b = 0; b < BlockSize; ++b )
+        {
+        buffer[b] = block[b];
+        }
+      for ( unsigned int b = 0; b < BlockSize; ++b )
+        {
+        out[x + b] = buffer[BlockSize - 1 - b];
+        }
+      }
+
+    for ( ; x < length; ++x )
+      {
+      out[x] = *( in - x );
+      }
+    return;
+    }
+
+  for ( SizeValueType x = 0; x < length; ++x, in += stride )
+    {
+    out[x] = *in;
+    }
+}
+
+/**
+ *
+ */
+template< class TInputImage, class TOutputImage >
+template< typename TInputPixel, typename TOutputPixel >
+void
+SliceImageFilter< TInputImage, TOutputImage >
+::DispatchedThreadedGenerateData( const Image< TInputPixel, ImageDimension > *inputPtr,
+                                  Image< TOutputPixel, ImageDimension > *outputPtr,
+                                  const OutputImageRegionType & outputRegionForThread,
+                                  ProgressReporter & progress )
+{
+  typedef Image< TOutputPixel, ImageDimension > OutputBufferImageType;
+
+  const InputIndexType start = this->GetClampedStart();
+
+  const TInputPixel    *inputBuffer = inputPtr->GetBufferPointer();
+  const OffsetValueType inputStride = m_Step[0] * inputPtr->GetOffsetTable()[0];
+
+  const SizeValueType ln = outputRegionForThread.GetSize(0);
+
+  ImageScanlineIterator< OutputBufferImageType > outIt( outputPtr, outputRegionForThread );
+
+  InputIndexType srcIndex;
+
+  while ( !outIt.IsAtEnd() )
+    {
+    // The source of the first pixel of the line, the following are
+    // at a constant stride
+    const OutputIndexType destIndex = outIt.GetIndex();
+    for( unsigned int i = 0; i < TOutputImage::ImageDimension; ++i )
+      {
+      srcIndex[i] = destIndex[i]*m_Step[i] + start[i];
+      }
+
+    CopyScanline( inputBuffer + inputPtr->ComputeOffset( srcIndex ), inputStride, &outIt.Value(), ln );
+
+    for ( SizeValueType x = 0; x < ln; ++x )
+      {
+      progress.CompletedPixel();
+      }
+    outIt.NextLine();
+    }
+}
+
+/**
+ *
+ */
+template< class TInputImage, class TOutputImage >
+template< typename TInputPixel, typename TOutputPixel >
+void
+SliceImageFilter< TInputImage, TOutputImage >
+::DispatchedThreadedGenerateData( const VectorImage< TInputPixel, ImageDimension > *inputPtr,
+                                  VectorImage< TOutputPixel, ImageDimension > *outputPtr,
+                                  const OutputImageRegionType & outputRegionForThread,
+                                  ProgressReporter & progress )
+{
+  typedef VectorImage< TOutputPixel, ImageDimension > OutputBufferImageType;
+
+  const unsigned int components = inputPtr->GetNumberOfComponentsPerPixel();
+  if ( outputPtr->GetNumberOfComponentsPerPixel() != components )
+    {
+    itkExceptionMacro( "The output has " << outputPtr->GetNumberOfComponentsPerPixel()
+                       << " components per pixel instead of " << components );
+    }
+
+  const InputIndexType start = this->GetClampedStart();
+
+  const TInputPixel    *inputBuffer = inputPtr->GetBufferPointer();
+  TOutputPixel         *outputBuffer = outputPtr->GetBufferPointer();
+  const OffsetValueType inputStride = m_Step[0] * inputPtr->GetOffsetTable()[0] * static_cast< OffsetValueType >( components );
+
+  const SizeValueType ln = outputRegionForThread.GetSize(0);
+
+  ImageScanlineIterator< OutputBufferImageType > outIt( outputPtr, outputRegionForThread );
+
+  InputIndexType srcIndex;
+
+  while ( !outIt.IsAtEnd() )
+    {
+    const OutputIndexType destIndex = outIt.GetIndex();
+    for( unsigned int i = 0; i < TOutputImage::ImageDimension; ++i )
+      {
+      srcIndex[i] = destIndex[i]*m_Step[i] + start[i];
+      }
+
+    const TInputPixel *in = inputBuffer + inputPtr->ComputeOffset( srcIndex ) * components;
+    TOutputPixel      *out = outputBuffer + outputPtr->ComputeOffset( destIndex ) * components;
+
+    if ( m_Step[0] == 1 )
+      {
+      // the components of the line are contiguous
+      std::copy( in, in + ln * components, out );
+      }
+    else
+      {
+      for ( SizeValueType x = 0; x < ln; ++x, in += inputStride, out += components )
+        {
+        std::copy( in, in + components, out );
+        }
+      }
+
+    for ( SizeValueType x = 0; x < ln; ++x )
+      {
+      progress.CompletedPixel();
+      }
+    outIt.NextLine();
+    }
+}
+
+/**
+ *
+ */
+template< class TInputImage, class TOutputImage >
+void
+SliceImageFilter< TInputImage, TOutputImage >
+::ThreadedGenerateDataByPixel(const OutputImageRegionType & outputRegionForThread,
+                              ProgressReporter & progress)
+{
+  // Get the input and output pointers
+  InputImageConstPointer inputPtr = this->GetInput();
+  OutputImagePointer     outputPtr = this->GetOutput();
+
+  const InputIndexType start = this->GetClampedStart();
 
   // Define/declare an iterator that will walk the output region for this
   // thread.
@@ -238,6 +615,15 @@ SliceImageFilter< TInputImage, TOutputImage >
     }
 
 
+  // when requesting the slices one by one, request the first needed
+  // slice
+  const unsigned int lastDim = TInputImage::ImageDimension - 1;
+  if ( this->IsSparseInputRequest() && inputRequestedRegionSize[lastDim] > 0 )
+    {
+    inputRequestedRegionIndex[lastDim] = outputRequestedRegionStartIndex[lastDim] * m_Step[lastDim] + start[lastDim];
+    inputRequestedRegionSize[lastDim] = 1;
+    }
+
   typename TInputImage::RegionType inputRequestedRegion;
   inputRequestedRegion.SetIndex(inputRequestedRegionIndex);
   inputRequestedRegion.SetSize(inputRequestedRegionSize);
@@ -0,0 +1,74 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkStaticCastFunctor_h
+#define itkStaticCastFunctor_h
+
+#include "itkIntTypes.h"
+
+namespace itk
+{
+namespace Functor
+{
+/**
+ * \class StaticCast
+ * \brief Converts the argument with static_cast.
+ *
+ * Used between the functors of a Compose chain to change the pixel
+ * type.
+ *
+ * \sa Compose
+ * \ingroup SimpleITKFiltersModule
+ */
+template< class TInput, class TOutput >
+class StaticCast
+{
+public:
+  // Use default copy, assigned and destructor
+  // StaticCast() {} default constructor OK
+
+  typedef TInput  InputType;
+  typedef TOutput OutputType;
+
+  bool operator!=(const StaticCast &) const
+    {
+      return false;
+    }
+
+  bool operator==(const StaticCast & other) const
+    {
+      return !( *this != other );
+    }
+
+  inline TOutput operator()(const TInput & A) const
+    {
+      return static_cast<TOutput>( A );
+    }
+
+  /** Compute count consecutive pixels */
+  void Evaluate( const TInput *input, TOutput *output, SizeValueType count ) const
+    {
+      for ( SizeValueType n = 0; n < count; ++n )
+        {
+        output[n] = static_cast<TOutput>( input[n] );
+        }
+    }
+};
+}
+}
+
+#endif // itkStaticCastFunctor_h
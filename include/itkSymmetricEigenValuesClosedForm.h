@@ -0,0 +1,180 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSymmetricEigenValuesClosedForm_h
+#define itkSymmetricEigenValuesClosedForm_h
+
+#include "itkIntTypes.h"
+#include "itkMath.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+/** \class SymmetricEigenValuesClosedForm
+ * \brief Computes the eigenvalues of 2x2 and 3x3 symmetric matrices
+ * analytically.
+ *
+ * The matrices are given by the upper triangle by rows, the storage
+ * order of the SymmetricSecondRankTensor, and the eigenvalues are
+ * sorted in ascending order as by SymmetricEigenAnalysis.
+ *
+ * The 2x2 eigenvalues are the roots of the characteristic
+ * polynomial. The 3x3 eigenvalues use the trigonometric solution of
+ * the characteristic cubic of the matrix shifted by its mean
+ * eigenvalue and scaled to unit deviation. The error relative to the
+ * norm of the matrix is about the square root of the precision of
+ * TRealType when two eigenvalues nearly coincide, and about the
+ * precision otherwise.
+ *
+ * The batch method computes consecutive matrices in one loop without
+ * iterations, so its cost does not depend on the matrix as the QL
+ * iterations of SymmetricEigenAnalysis do. The loop is not expected
+ * to be vectorized: the 3x3 solution calls std::sqrt, std::acos and
+ * std::cos, which compilers vectorize only with a vector math
+ * library. itkObjectnessMeasureImageFilterBenchmark reports the
+ * throughput of both solvers.
+ *
+ * Only the dimensions 2 and 3 are implemented.
+ *
+ * \sa SymmetricEigenAnalysis
+ *
+ * \ingroup SimpleITKFiltersModule
+ */
+template< typename TRealType, unsigned int VDimension >
+class SymmetricEigenValuesClosedForm;
+
+template< typename TRealType >
+class SymmetricEigenValuesClosedForm< TRealType, 2 >
+{
+public:
+  /** Number of components of a matrix */
+  itkStaticConstMacro(NumberOfComponents, unsigned int, 3);
+
+  /** Compute the eigenvalues of count matrices of 3 consecutive
+   * components into count times 2 consecutive eigenvalues */
+  static void ComputeEigenValues( const TRealType *matrices, TRealType *eigenValues, SizeValueType count )
+    {
+      const TRealType oneHalf = 0.5;
+
+      for ( SizeValueType n = 0; n < count; ++n )
+        {
+        const TRealType *m = matrices + 3*n;
+        TRealType *      e = eigenValues + 2*n;
+
+        const TRealType mean = oneHalf * ( m[0] + m[2] );
+        const TRealType half = oneHalf * ( m[0] - m[2] );
+        const TRealType d = std::sqrt( half * half + m[1] * m[1] );
+
+        e[0] = mean - d;
+        e[1] = mean + d;
+        }
+    }
+
+  /** Compute the eigenvalues of one matrix, such as a
+   * SymmetricSecondRankTensor, into an array */
+  template< typename TMatrix, typename TEigenValues >
+  static void ComputeEigenValues( const TMatrix &matrix, TEigenValues &eigenValues )
+    {
+      TRealType m[3];
+      TRealType e[2];
+      for ( unsigned int i = 0; i < 3; ++i )
+        {
+        m[i] = static_cast< TRealType >( matrix[i] );
+        }
+      ComputeEigenValues( m, e, 1 );
+      eigenValues[0] = e[0];
+      eigenValues[1] = e[1];
+    }
+};
+
+template< typename TRealType >
+class SymmetricEigenValuesClosedForm< TRealType, 3 >
+{
+public:
+  /** Number of components of a matrix */
+  itkStaticConstMacro(NumberOfComponents, unsigned int, 6);
+
+  /** Compute the eigenvalues of count matrices of 6 consecutive
+   * components into count times 3 consecutive eigenvalues */
+  static void ComputeEigenValues( const TRealType *matrices, TRealType *eigenValues, SizeValueType count )
+    {
+      // constants of TRealType, so float matrices are computed in float
+      const TRealType twoThirdsPi = 2.0 * Math::pi / 3.0;
+      const TRealType zero = 0.0;
+      const TRealType one = 1.0;
+      const TRealType two = 2.0;
+      const TRealType three = 3.0;
+      const TRealType oneHalf = 0.5;
+      const TRealType oneThird = 1.0 / 3.0;
+      const TRealType oneSixth = 1.0 / 6.0;
+
+      for ( SizeValueType n = 0; n < count; ++n )
+        {
+        const TRealType *m = matrices + 6*n;
+        TRealType *      e = eigenValues + 3*n;
+
+        // shift by the mean eigenvalue
+        const TRealType q = ( m[0] + m[3] + m[5] ) * oneThird;
+        const TRealType a00 = m[0] - q;
+        const TRealType a11 = m[3] - q;
+        const TRealType a22 = m[5] - q;
+        const TRealType a01 = m[1];
+        const TRealType a02 = m[2];
+        const TRealType a12 = m[4];
+
+        // deviation of the eigenvalues, zero for a multiple of the identity
+        const TRealType p2 = a00*a00 + a11*a11 + a22*a22 + two * ( a01*a01 + a02*a02 + a12*a12 );
+        const TRealType p = std::sqrt( p2 * oneSixth );
+        const TRealType invP = ( p > zero ) ? one / p : zero;
+
+        // half the determinant of the scaled matrix, within [-1,1]
+        const TRealType det = a00 * ( a11*a22 - a12*a12 )
+          - a01 * ( a01*a22 - a12*a02 )
+          + a02 * ( a01*a12 - a11*a02 );
+        const TRealType r = std::min( std::max( oneHalf * det * invP * invP * invP, -one ), one );
+
+        const TRealType phi = std::acos( r ) * oneThird;
+
+        e[2] = q + two * p * std::cos( phi );
+        e[0] = q + two * p * std::cos( phi + twoThirdsPi );
+        e[1] = three * q - e[0] - e[2];
+        }
+    }
+
+  /** Compute the eigenvalues of one matrix, such as a
+   * SymmetricSecondRankTensor, into an array */
+  template< typename TMatrix, typename TEigenValues >
+  static void ComputeEigenValues( const TMatrix &matrix, TEigenValues &eigenValues )
+    {
+      TRealType m[6];
+      TRealType e[3];
+      for ( unsigned int i = 0; i < 6; ++i )
+        {
+        m[i] = static_cast< TRealType >( matrix[i] );
+        }
+      ComputeEigenValues( m, e, 1 );
+      eigenValues[0] = e[0];
+      eigenValues[1] = e[1];
+      eigenValues[2] = e[2];
+    }
+};
+
+}
+
+#endif // itkSymmetricEigenValuesClosedForm_h
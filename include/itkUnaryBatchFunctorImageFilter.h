@@ -0,0 +1,111 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkUnaryBatchFunctorImageFilter_h
+#define itkUnaryBatchFunctorImageFilter_h
+
+#include "itkUnaryFunctorImageFilter.h"
+#include "itkImage.h"
+
+namespace itk
+{
+/** \class UnaryBatchFunctorImageFilter
+ * \brief Implements a pixel-wise operator on an image with a functor
+ * evaluated by scanlines.
+ *
+ * The functor must provide, in addition to the operator() used by
+ * UnaryFunctorImageFilter, the batch method
+ * \code
+ *   void Evaluate( const InputPixelType *input, OutputPixelType *output, SizeValueType count ) const;
+ * \endcode
+ * as the BitwiseNot and UnaryMinus functors of this module do. A
+ * Compose functor of them computes a chain of operations in a single
+ * pass, without intermediate images.
+ *
+ * When the input and the output are Images, each line of the output
+ * region is computed by one call to Evaluate on the contiguous
+ * buffers. The line is read at the same index in the input, whose
+ * buffered region must contain the output region, as it does with
+ * the requested region of UnaryFunctorImageFilter, otherwise an
+ * exception is thrown. Other image types, such as image adaptors, are
+ * computed pixel by pixel by UnaryFunctorImageFilter.
+ *
+ * \sa UnaryFunctorImageFilter Functor::Compose
+ *
+ * \ingroup IntensityImageFilters MultiThreaded
+ * \ingroup SimpleITKFiltersModule
+ */
+template< typename TInputImage, typename TOutputImage, typename TFunction >
+class ITK_EXPORT UnaryBatchFunctorImageFilter:
+  public UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
+{
+public:
+  /** Standard class typedefs. */
+  typedef UnaryBatchFunctorImageFilter                                    Self;
+  typedef UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction > Superclass;
+  typedef SmartPointer< Self >                                            Pointer;
+  typedef SmartPointer< const Self >                                      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(UnaryBatchFunctorImageFilter, UnaryFunctorImageFilter);
+
+  typedef typename Superclass::FunctorType           FunctorType;
+  typedef typename Superclass::InputImageType        InputImageType;
+  typedef typename Superclass::OutputImageType       OutputImageType;
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int,
+                      TOutputImage::ImageDimension);
+
+protected:
+  UnaryBatchFunctorImageFilter() {}
+  virtual ~UnaryBatchFunctorImageFilter() {}
+
+  void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                            ThreadIdType threadId) ITK_OVERRIDE;
+
+private:
+  UnaryBatchFunctorImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);               //purposely not implemented
+
+  /** Compute the output region by scanlines when the input and the
+   * output are Images, pixel by pixel otherwise */
+  template< typename TInputPixel, typename TOutputPixel >
+  void DispatchedThreadedGenerateData( const Image< TInputPixel, ImageDimension > *inputPtr,
+                                       Image< TOutputPixel, ImageDimension > *outputPtr,
+                                       const OutputImageRegionType & outputRegionForThread,
+                                       ThreadIdType threadId );
+
+  template< typename TInput, typename TOutput >
+  void DispatchedThreadedGenerateData( const TInput *,
+                                       TOutput *,
+                                       const OutputImageRegionType & outputRegionForThread,
+                                       ThreadIdType threadId )
+    {
+      this->Superclass::ThreadedGenerateData( outputRegionForThread, threadId );
+    }
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkUnaryBatchFunctorImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,86 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkUnaryBatchFunctorImageFilter_hxx
+#define itkUnaryBatchFunctorImageFilter_hxx
+
+#include "itkUnaryBatchFunctorImageFilter.h"
+#include "itkImageScanlineIterator.h"
+#include "itkProgressReporter.h"
+
+namespace itk
+{
+/**
+ *
+ */
+template< typename TInputImage, typename TOutputImage, typename TFunction >
+void
+UnaryBatchFunctorImageFilter< TInputImage, TOutputImage, TFunction >
+::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                       ThreadIdType threadId)
+{
+  this->DispatchedThreadedGenerateData( this->GetInput(), this->GetOutput(), outputRegionForThread, threadId );
+}
+
+/**
+ *
+ */
+template< typename TInputImage, typename TOutputImage, typename TFunction >
+template< typename TInputPixel, typename TOutputPixel >
+void
+UnaryBatchFunctorImageFilter< TInputImage, TOutputImage, TFunction >
+::DispatchedThreadedGenerateData( const Image< TInputPixel, ImageDimension > *inputPtr,
+                                  Image< TOutputPixel, ImageDimension > *outputPtr,
+                                  const OutputImageRegionType & outputRegionForThread,
+                                  ThreadIdType threadId )
+{
+  typedef Image< TOutputPixel, ImageDimension > OutputBufferImageType;
+
+  const SizeValueType size0 = outputRegionForThread.GetSize(0);
+  if ( size0 == 0 )
+    {
+    return;
+    }
+
+  // the lines are read at the output's indices
+  if ( !inputPtr->GetBufferedRegion().IsInside( outputRegionForThread ) )
+    {
+    itkExceptionMacro( << "The input's buffered region " << inputPtr->GetBufferedRegion()
+                       << " does not contain the output region " << outputRegionForThread );
+    }
+
+  // Support progress methods/callbacks
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() / size0 );
+
+  const FunctorType & functor = this->GetFunctor();
+  const TInputPixel * inputBuffer = inputPtr->GetBufferPointer();
+
+  ImageScanlineIterator< OutputBufferImageType > outIt( outputPtr, outputRegionForThread );
+
+  while ( !outIt.IsAtEnd() )
+    {
+    // The input's requested region is the output region, so the line
+    // is contiguous in both buffers
+    functor.Evaluate( inputBuffer + inputPtr->ComputeOffset( outIt.GetIndex() ), &outIt.Value(), size0 );
+
+    outIt.NextLine();
+    progress.CompletedPixel(); // potential exception thrown here
+    }
+}
+} // end namespace itk
+
+#endif
@@ -18,6 +18,8 @@
 #ifndef itkUnaryMinusFunctor_h
 #define itkUnaryMinusFunctor_h
 
+#include "itkIntTypes.h"
+
 namespace itk
 {
 namespace Functor
@@ -26,12 +28,22 @@ namespace Functor
  * \class UnaryMinus
  * \brief Applies the unary minus operator to the argument.
  *
+ * The Evaluate method computes consecutive pixels in a loop without
+ * calls or branches. It is only vectorized when auto-vectorization is
+ * enabled, -O3 with GCC, and with the baseline ISA of the build, SSE2
+ * on x86-64; a conversion between pixel types of different sizes may
+ * keep it scalar. itkBatchFunctorImageFilterBenchmark reports the
+ * speedup over the pixel by pixel filter.
+ *
  * \ingroup SimpleITKFiltersModule
  */
 template< class TInput1, class TOutput = TInput1 >
 class UnaryMinus
 {
 public:
+  typedef TInput1 InputType;
+  typedef TOutput OutputType;
+
   UnaryMinus() {}
   ~UnaryMinus() {}
   bool operator!=(const UnaryMinus &) const
@@ -46,6 +58,15 @@ public:
 
   inline TOutput operator()(const TInput1 & A ) const
   { return (TOutput)( -A ); }
+
+  /** Compute count consecutive pixels */
+  void Evaluate( const TInput1 *input, TOutput *output, SizeValueType count ) const
+  {
+    for ( SizeValueType n = 0; n < count; ++n )
+      {
+      output[n] = (TOutput)( -input[n] );
+      }
+  }
 };
 }
 }
@@ -0,0 +1,169 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkUnaryBatchFunctorImageFilter.h"
+#include "itkBinaryBatchFunctorImageFilter.h"
+#include "itkUnaryMinusFunctor.h"
+#include "itkBitwiseNotFunctor.h"
+#include "itkDivideFloorFunctor.h"
+#include "itkDivideRealFunctor.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkTimeProbe.h"
+
+#include <cstdlib>
+
+//
+// Times the batch functor filters, which call the branch-free
+// Evaluate loops of the functors by scanlines, against
+// UnaryFunctorImageFilter and BinaryFunctorImageFilter, which call
+// the functor pixel by pixel through iterators, for example:
+//   itkBatchFunctorImageFilterBenchmark 256 256 256 5
+//
+namespace
+{
+
+typedef itk::Image< short, 3 > ShortImageType;
+typedef itk::Image< float, 3 > FloatImageType;
+
+template< typename TImage >
+bool SameImages( const TImage *image1, const TImage *image2 )
+{
+  itk::ImageRegionConstIterator< TImage > it1( image1, image1->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< TImage > it2( image2, image2->GetBufferedRegion() );
+  for ( ; !it1.IsAtEnd(); ++it1, ++it2 )
+    {
+    if ( it1.Get() != it2.Get() )
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+template< typename TFilter >
+double TimeFilter( TFilter *filter, unsigned int iterations )
+{
+  itk::TimeProbe probe;
+  for ( unsigned int i = 0; i < iterations; ++i )
+    {
+    filter->Modified();
+    probe.Start();
+    filter->Update();
+    probe.Stop();
+    }
+  return probe.GetMean();
+}
+
+void Report( const char *name, double pixels, double pixelSeconds, double batchSeconds, bool match )
+{
+  std::cout << name << ": pixels " << 1e9 * pixelSeconds / pixels << " ns/pixel, "
+            << "batch " << 1e9 * batchSeconds / pixels << " ns/pixel, "
+            << "speedup " << pixelSeconds / batchSeconds
+            << ( match ? "" : " MISMATCH" ) << std::endl;
+}
+
+template< typename TInputImage, typename TOutputImage, typename TFunctor >
+bool TimeUnary( const char *name, const TInputImage *image, unsigned int iterations )
+{
+  typedef itk::UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunctor > FilterType;
+  typename FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( image );
+
+  typedef itk::UnaryBatchFunctorImageFilter< TInputImage, TOutputImage, TFunctor > BatchFilterType;
+  typename BatchFilterType::Pointer batchFilter = BatchFilterType::New();
+  batchFilter->SetInput( image );
+
+  const double pixelSeconds = TimeFilter( filter.GetPointer(), iterations );
+  const double batchSeconds = TimeFilter( batchFilter.GetPointer(), iterations );
+
+  const bool match = SameImages< TOutputImage >( filter->GetOutput(), batchFilter->GetOutput() );
+  Report( name, image->GetBufferedRegion().GetNumberOfPixels(), pixelSeconds, batchSeconds, match );
+  return match;
+}
+
+template< typename TInputImage, typename TOutputImage, typename TFunctor >
+bool TimeBinary( const char *name, const TInputImage *image1, const TInputImage *image2, unsigned int iterations )
+{
+  typedef itk::BinaryFunctorImageFilter< TInputImage, TInputImage, TOutputImage, TFunctor > FilterType;
+  typename FilterType::Pointer filter = FilterType::New();
+  filter->SetInput1( image1 );
+  filter->SetInput2( image2 );
+
+  typedef itk::BinaryBatchFunctorImageFilter< TInputImage, TInputImage, TOutputImage, TFunctor > BatchFilterType;
+  typename BatchFilterType::Pointer batchFilter = BatchFilterType::New();
+  batchFilter->SetInput1( image1 );
+  batchFilter->SetInput2( image2 );
+
+  const double pixelSeconds = TimeFilter( filter.GetPointer(), iterations );
+  const double batchSeconds = TimeFilter( batchFilter.GetPointer(), iterations );
+
+  const bool match = SameImages< TOutputImage >( filter->GetOutput(), batchFilter->GetOutput() );
+  Report( name, image1->GetBufferedRegion().GetNumberOfPixels(), pixelSeconds, batchSeconds, match );
+  return match;
+}
+
+ShortImageType::Pointer MakeImage( const ShortImageType::SizeType &size, unsigned int seed, int range )
+{
+  ShortImageType::Pointer image = ShortImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+
+  // signed values of both signs, and a few zeros
+  itk::ImageRegionIterator< ShortImageType > it( image, image->GetLargestPossibleRegion() );
+  for ( unsigned int n = 0; !it.IsAtEnd(); ++it, ++n )
+    {
+    it.Set( static_cast< short >( static_cast< int >( ( n * seed ) % ( 2 * range + 1 ) ) - range ) );
+    }
+  return image;
+}
+
+}
+
+int itkBatchFunctorImageFilterBenchmark( int argc, char *argv[] )
+{
+  if ( argc < 4 )
+    {
+    std::cerr << "Usage: " << argv[0] << " sizeX sizeY sizeZ [iterations]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ShortImageType::SizeType size;
+  for ( unsigned int i = 0; i < 3; ++i )
+    {
+    size[i] = atoi( argv[i+1] );
+    }
+  const unsigned int iterations = ( argc > 4 ) ? atoi( argv[4] ) : 3;
+
+  ShortImageType::Pointer image1 = MakeImage( size, 2654435761u, 1000 );
+  ShortImageType::Pointer image2 = MakeImage( size, 40503u, 11 );
+
+  std::cout << "Image size: " << size << " iterations: " << iterations << std::endl;
+
+  typedef itk::Functor::UnaryMinus< short, short >      MinusType;
+  typedef itk::Functor::BitwiseNot< short, short >      NotType;
+  typedef itk::Functor::DivFloor< short, short, short > DivFloorType;
+  typedef itk::Functor::DivReal< short, short, float >  DivRealType;
+
+  bool match = true;
+  match &= TimeUnary< ShortImageType, ShortImageType, MinusType >( "UnaryMinus", image1, iterations );
+  match &= TimeUnary< ShortImageType, ShortImageType, NotType >( "BitwiseNot", image1, iterations );
+  match &= TimeBinary< ShortImageType, ShortImageType, DivFloorType >( "DivFloor", image1, image2, iterations );
+  match &= TimeBinary< ShortImageType, FloatImageType, DivRealType >( "DivReal", image1, image2, iterations );
+
+  return match ? EXIT_SUCCESS : EXIT_FAILURE;
+}
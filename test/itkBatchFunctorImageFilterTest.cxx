@@ -0,0 +1,173 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+#include "itkUnaryBatchFunctorImageFilter.h"
+#include "itkBinaryBatchFunctorImageFilter.h"
+#include "itkUnaryMinusFunctor.h"
+#include "itkDivideFloorFunctor.h"
+#include "itkDivideRealFunctor.h"
+#include "itkBitwiseNotFunctor.h"
+#include "itkStaticCastFunctor.h"
+#include "itkComposeFunctor.h"
+
+#include "gtest/gtest.h"
+
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+
+namespace
+{
+
+const unsigned int ImageDimension = 3;
+typedef itk::Image<short, ImageDimension>         ShortImageType;
+typedef itk::Image<int, ImageDimension>           IntImageType;
+typedef itk::Image<float, ImageDimension>         FloatImageType;
+typedef itk::Image<unsigned char, ImageDimension> MaskImageType;
+
+template <typename TImageType>
+typename TImageType::Pointer MakeImage( int seed )
+{
+  typename TImageType::SizeType size = {{17,9,5}};
+  typename TImageType::IndexType index = {{-4,3,1}};
+
+  typename TImageType::Pointer image = TImageType::New();
+  image->SetRegions( typename TImageType::RegionType( index, size ) );
+  image->Allocate();
+
+  itk::ImageRegionIterator<TImageType> it( image, image->GetLargestPossibleRegion() );
+  for ( int n = 0; !it.IsAtEnd(); ++it, ++n )
+    {
+    it.Set( static_cast<typename TImageType::PixelType>( ( n * seed ) % 23 - 11 ) );
+    }
+  return image;
+}
+
+template <typename TImageType>
+void ExpectEqualImages( const TImageType *expected, const TImageType *image )
+{
+  ASSERT_EQ( expected->GetBufferedRegion(), image->GetBufferedRegion() );
+
+  itk::ImageRegionConstIterator<TImageType> eit( expected, expected->GetBufferedRegion() );
+  itk::ImageRegionConstIterator<TImageType> it( image, image->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it, ++eit )
+    {
+    ASSERT_EQ( eit.Get(), it.Get() ) << "Index: " << it.GetIndex();
+    }
+}
+
+}
+
+TEST(BatchFunctorImageFilterTests, Unary)
+{
+  typedef itk::Functor::UnaryMinus<short, int> FunctorType;
+
+  ShortImageType::Pointer image = MakeImage<ShortImageType>( 7 );
+
+  typedef itk::UnaryFunctorImageFilter<ShortImageType, IntImageType, FunctorType> FilterType;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( image );
+  filter->Update();
+
+  typedef itk::UnaryBatchFunctorImageFilter<ShortImageType, IntImageType, FunctorType> BatchFilterType;
+  BatchFilterType::Pointer batchFilter = BatchFilterType::New();
+  batchFilter->SetInput( image );
+  batchFilter->Update();
+
+  ExpectEqualImages<IntImageType>( filter->GetOutput(), batchFilter->GetOutput() );
+}
+
+TEST(BatchFunctorImageFilterTests, Binary)
+{
+  typedef itk::Functor::DivFloor<short, int, int> FunctorType;
+
+  ShortImageType::Pointer image1 = MakeImage<ShortImageType>( 7 );
+  IntImageType::Pointer   image2 = MakeImage<IntImageType>( 5 );
+
+  typedef itk::BinaryFunctorImageFilter<ShortImageType, IntImageType, IntImageType, FunctorType> FilterType;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput1( image1 );
+  filter->SetInput2( image2 );
+  filter->Update();
+
+  typedef itk::BinaryBatchFunctorImageFilter<ShortImageType, IntImageType, IntImageType, FunctorType> BatchFilterType;
+  BatchFilterType::Pointer batchFilter = BatchFilterType::New();
+  batchFilter->SetInput1( image1 );
+  batchFilter->SetInput2( image2 );
+  batchFilter->Update();
+
+  ExpectEqualImages<IntImageType>( filter->GetOutput(), batchFilter->GetOutput() );
+
+  // a constant divisor is computed pixel by pixel
+  filter->SetConstant2( -3 );
+  filter->Update();
+  batchFilter->SetConstant2( -3 );
+  batchFilter->Update();
+
+  ExpectEqualImages<IntImageType>( filter->GetOutput(), batchFilter->GetOutput() );
+
+  // and with the constant divisor functor
+  typedef itk::Functor::DivFloorByConstant<short, int, int>                                    ConstantFunctorType;
+  typedef itk::UnaryBatchFunctorImageFilter<ShortImageType, IntImageType, ConstantFunctorType> ConstantFilterType;
+  ConstantFilterType::Pointer constantFilter = ConstantFilterType::New();
+  constantFilter->SetInput( image1 );
+  constantFilter->GetFunctor().SetDivisor( -3 );
+  constantFilter->Update();
+
+  ExpectEqualImages<IntImageType>( filter->GetOutput(), constantFilter->GetOutput() );
+}
+
+TEST(BatchFunctorImageFilterTests, Compose)
+{
+  typedef itk::Functor::UnaryMinus<short, short>                   MinusType;
+  typedef itk::Functor::DivRealByConstant<short, short, float>     DivideType;
+  typedef itk::Functor::StaticCast<float, short>                   CastType;
+  typedef itk::Functor::BitwiseNot<short, unsigned char>           NotType;
+  typedef itk::Functor::Compose<MinusType, DivideType>             MinusDivideType;
+  typedef itk::Functor::Compose<MinusDivideType, CastType>         MinusDivideCastType;
+  typedef itk::Functor::Compose<MinusDivideCastType, NotType>      ChainType;
+
+  ShortImageType::Pointer image = MakeImage<ShortImageType>( 7 );
+
+  // one filter per operation
+  typedef itk::UnaryFunctorImageFilter<ShortImageType, ShortImageType, MinusType> MinusFilterType;
+  MinusFilterType::Pointer minus = MinusFilterType::New();
+  minus->SetInput( image );
+
+  typedef itk::UnaryFunctorImageFilter<ShortImageType, FloatImageType, DivideType> DivideFilterType;
+  DivideFilterType::Pointer divide = DivideFilterType::New();
+  divide->SetInput( minus->GetOutput() );
+  divide->GetFunctor().SetDivisor( -2 );
+
+  typedef itk::UnaryFunctorImageFilter<FloatImageType, ShortImageType, CastType> CastFilterType;
+  CastFilterType::Pointer cast = CastFilterType::New();
+  cast->SetInput( divide->GetOutput() );
+
+  typedef itk::UnaryFunctorImageFilter<ShortImageType, MaskImageType, NotType> NotFilterType;
+  NotFilterType::Pointer bitwiseNot = NotFilterType::New();
+  bitwiseNot->SetInput( cast->GetOutput() );
+  bitwiseNot->Update();
+
+  // the chain in a single pass
+  typedef itk::UnaryBatchFunctorImageFilter<ShortImageType, MaskImageType, ChainType> ChainFilterType;
+  ChainFilterType::Pointer chain = ChainFilterType::New();
+  chain->SetInput( image );
+  chain->GetFunctor().GetFirst().GetFirst().GetSecond().SetDivisor( -2 );
+  chain->Update();
+
+  ExpectEqualImages<MaskImageType>( bitwiseNot->GetOutput(), chain->GetOutput() );
+}
@@ -0,0 +1,215 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+#include <itkDeinterleaveImageFilter.h>
+#include <itkSliceImageFilter.h>
+
+#include "gtest/gtest.h"
+
+#include "itkPhysicalPointImageSource.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkCommand.h"
+#include "itkStreamingImageFilter.h"
+
+
+// Each phase output is compared with the input slices of the phase,
+// and with the SliceImageFilter of the same start and step on the
+// slices they have in common, on an image of the physical points.
+
+namespace
+{
+
+const unsigned int ImageDimension = 3;
+typedef itk::Point<double, ImageDimension>    PixelType;
+typedef itk::Image<PixelType, ImageDimension> ImageType;
+
+typedef itk::PhysicalPointImageSource<ImageType>          SourceType;
+typedef itk::DeinterleaveImageFilter<ImageType, ImageType> FilterType;
+
+SourceType::Pointer MakeSource( void )
+{
+  SourceType::Pointer source = SourceType::New();
+
+  SourceType::SizeValueType size[] = {17,12,11};
+  source->SetSize( size );
+
+  float origin[] = {1.1f, -2.2f, 3.3f};
+  source->SetOrigin( origin );
+
+  return source;
+}
+
+// Counts the events a filter invokes
+class EventCounter
+  : public itk::Command
+{
+public:
+  typedef EventCounter              Self;
+  typedef itk::Command              Superclass;
+  typedef itk::SmartPointer< Self > Pointer;
+
+  itkNewMacro(Self);
+
+  void Execute( itk::Object *caller, const itk::EventObject & event ) ITK_OVERRIDE
+    {
+      this->Execute( const_cast< const itk::Object * >( caller ), event );
+    }
+
+  void Execute( const itk::Object *, const itk::EventObject & ) ITK_OVERRIDE
+    {
+      ++m_Count;
+    }
+
+  unsigned int m_Count;
+
+protected:
+  EventCounter() : m_Count( 0 ) {}
+};
+
+// The buffered pixels of the phase are the input slices k, k+N...
+void ExpectPhasePixels( const ImageType *input, const ImageType *phase, unsigned int dimension, unsigned int k, unsigned int numberOfPhases )
+{
+  const ImageType::IndexType inputStart = input->GetLargestPossibleRegion().GetIndex();
+
+  itk::ImageRegionConstIteratorWithIndex<ImageType> it( phase, phase->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    ImageType::IndexType idx = it.GetIndex();
+    for ( unsigned int i = 0; i < ImageDimension; ++i )
+      {
+      idx[i] += inputStart[i];
+      }
+    idx[dimension] += k + ( numberOfPhases - 1 ) * it.GetIndex()[dimension];
+
+    ASSERT_EQ( input->GetPixel( idx ), it.Get() ) << "Phase " << k << " Index: " << it.GetIndex();
+    }
+}
+
+void ExpectSameAsSlice( const ImageType *input, const ImageType *phase, unsigned int dimension, unsigned int k, unsigned int numberOfPhases )
+{
+  // the phase has ceil((size-k)/N) slices
+  const itk::SizeValueType inputSlices = input->GetLargestPossibleRegion().GetSize()[dimension];
+  ASSERT_EQ( ( inputSlices - k + numberOfPhases - 1 ) / numberOfPhases, phase->GetLargestPossibleRegion().GetSize()[dimension] )
+    << "Phase " << k;
+
+  ExpectPhasePixels( input, phase, dimension, k, numberOfPhases );
+
+  typedef itk::SliceImageFilter<ImageType, ImageType> SliceFilterType;
+  SliceFilterType::Pointer slice = SliceFilterType::New();
+  slice->SetInput( input );
+
+  SliceFilterType::IndexType start;
+  start.Fill( 0 );
+  start[dimension] = k;
+  slice->SetStart( start );
+
+  SliceFilterType::ArrayType step;
+  step.Fill( 1 );
+  step[dimension] = numberOfPhases;
+  slice->SetStep( step );
+  slice->Update();
+
+  const ImageType *expected = slice->GetOutput();
+
+  // the SliceImageFilter truncates to floor((size-k)/N) slices, and
+  // omits the last slice of the phase when N does not divide size-k
+  ASSERT_EQ( ( inputSlices - k ) / numberOfPhases, expected->GetLargestPossibleRegion().GetSize()[dimension] )
+    << "Phase " << k;
+  ASSERT_EQ( expected->GetOrigin(), phase->GetOrigin() ) << "Phase " << k;
+  ASSERT_EQ( expected->GetSpacing(), phase->GetSpacing() ) << "Phase " << k;
+
+  itk::ImageRegionConstIteratorWithIndex<ImageType> it( expected, expected->GetLargestPossibleRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    ASSERT_EQ( it.Get(), phase->GetPixel( it.GetIndex() ) ) << "Phase " << k << " Index: " << it.GetIndex();
+    }
+}
+
+}
+
+TEST(DeinterleaveImageFilterTests, Phases)
+{
+  SourceType::Pointer source = MakeSource();
+  source->Update();
+
+  for ( unsigned int dimension = 0; dimension < ImageDimension; ++dimension )
+    {
+    for ( unsigned int numberOfPhases = 1; numberOfPhases < 5; ++numberOfPhases )
+      {
+      FilterType::Pointer filter = FilterType::New();
+      filter->SetInput( source->GetOutput() );
+      filter->SetDimension( dimension );
+      filter->SetNumberOfPhases( numberOfPhases );
+      filter->Update();
+
+      ASSERT_EQ( numberOfPhases, filter->GetNumberOfIndexedOutputs() );
+
+      itk::SizeValueType slices = 0;
+      for ( unsigned int k = 0; k < numberOfPhases; ++k )
+        {
+        const ImageType *phase = filter->GetPhaseOutput( k );
+        slices += phase->GetLargestPossibleRegion().GetSize()[dimension];
+        ExpectSameAsSlice( source->GetOutput(), phase, dimension, k, numberOfPhases );
+        }
+      EXPECT_EQ( source->GetOutput()->GetLargestPossibleRegion().GetSize()[dimension], slices )
+        << "Every slice is in a phase";
+      }
+    }
+}
+
+TEST(DeinterleaveImageFilterTests, Streaming)
+{
+  SourceType::Pointer source = MakeSource();
+  source->Update();
+
+  SourceType::Pointer streamedSource = MakeSource();
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( streamedSource->GetOutput() );
+  filter->SetNumberOfPhases( 3 );
+  filter->SetDimension( 1 );
+
+  EventCounter::Pointer sourceCounter = EventCounter::New();
+  streamedSource->AddObserver( itk::StartEvent(), sourceCounter );
+  EventCounter::Pointer filterCounter = EventCounter::New();
+  filter->AddObserver( itk::StartEvent(), filterCounter );
+
+  // streaming the last phase computes the same regions of the others
+  typedef itk::StreamingImageFilter<ImageType, ImageType> StreamerType;
+  StreamerType::Pointer streamer = StreamerType::New();
+  streamer->SetInput( filter->GetPhaseOutput( 2 ) );
+  streamer->SetNumberOfStreamDivisions( 4 );
+  streamer->Update();
+
+  ExpectSameAsSlice( source->GetOutput(), streamer->GetOutput(), 1, 2, 3 );
+
+  // the 11 slices of the last dimension are split in 4 pieces, each
+  // read once from the source for all the phases
+  EXPECT_EQ( 4u, sourceCounter->m_Count );
+  EXPECT_EQ( 4u, filterCounter->m_Count );
+
+  // the other phases hold the last piece
+  const ImageType::RegionType lastPiece = filter->GetPhaseOutput( 2 )->GetBufferedRegion();
+  EXPECT_LT( lastPiece.GetNumberOfPixels(), filter->GetPhaseOutput( 2 )->GetLargestPossibleRegion().GetNumberOfPixels() );
+  for ( unsigned int k = 0; k < 3; ++k )
+    {
+    const ImageType *phase = filter->GetPhaseOutput( k );
+    EXPECT_EQ( lastPiece, phase->GetBufferedRegion() ) << "Phase " << k;
+    ExpectPhasePixels( source->GetOutput(), phase, 1, k, 3 );
+    }
+}
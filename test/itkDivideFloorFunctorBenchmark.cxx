@@ -0,0 +1,110 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkDivideFloorFunctor.h"
+#include "itkTimeProbe.h"
+
+#include <cstdlib>
+#include <vector>
+
+//
+// Times the batch evaluation of DivFloor on integer arrays, against
+// the division in double of every pixel, for example:
+//   itkDivideFloorFunctorBenchmark 16777216 10
+//
+namespace
+{
+
+// The route used before the integer operations
+template< typename TInput, typename TOutput >
+void DivideFloorByDouble( const TInput *input1, const TInput *input2, TOutput *output, itk::SizeValueType count )
+{
+  for ( itk::SizeValueType n = 0; n < count; ++n )
+    {
+    if ( input2[n] != TInput(0) )
+      {
+      output[n] = static_cast< TOutput >( std::floor( double( input1[n] ) / double( input2[n] ) ) );
+      }
+    else
+      {
+      output[n] = itk::NumericTraits< TOutput >::max();
+      }
+    }
+}
+
+template< typename TInput >
+bool TimeDivideFloor( const char *name, itk::SizeValueType count, unsigned int iterations )
+{
+  std::vector< TInput > input1( count );
+  std::vector< TInput > input2( count );
+  std::vector< TInput > output( count );
+  std::vector< TInput > expected( count );
+
+  for ( itk::SizeValueType n = 0; n < count; ++n )
+    {
+    // signed values of both signs, and a few zero divisors
+    input1[n] = static_cast< TInput >( static_cast< int >( ( n * 2654435761u ) % 201 ) - 100 );
+    input2[n] = static_cast< TInput >( static_cast< int >( ( n * 40503u ) % 23 ) - 11 );
+    }
+
+  itk::TimeProbe doubleProbe;
+  itk::TimeProbe batchProbe;
+  for ( unsigned int i = 0; i < iterations; ++i )
+    {
+    doubleProbe.Start();
+    DivideFloorByDouble( &input1[0], &input2[0], &expected[0], count );
+    doubleProbe.Stop();
+
+    itk::Functor::DivFloor< TInput, TInput, TInput > functor;
+    batchProbe.Start();
+    functor.Evaluate( &input1[0], &input2[0], &output[0], count );
+    batchProbe.Stop();
+    }
+
+  const bool match = ( output == expected );
+
+  std::cout << name << ": double " << 1e9 * doubleProbe.GetMean() / count << " ns/pixel, "
+            << "batch " << 1e9 * batchProbe.GetMean() / count << " ns/pixel, "
+            << "speedup " << doubleProbe.GetMean() / batchProbe.GetMean()
+            << ( match ? "" : " MISMATCH" ) << std::endl;
+
+  return match;
+}
+
+}
+
+int itkDivideFloorFunctorBenchmark( int argc, char *argv[] )
+{
+  if ( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " count [iterations]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const itk::SizeValueType count = atoi( argv[1] );
+  const unsigned int       iterations = ( argc > 2 ) ? atoi( argv[2] ) : 3;
+
+  std::cout << "Pixels: " << count << " iterations: " << iterations << std::endl;
+
+  bool match = true;
+  match &= TimeDivideFloor< itk::int8_t >( "int8", count, iterations );
+  match &= TimeDivideFloor< itk::int16_t >( "int16", count, iterations );
+  match &= TimeDivideFloor< itk::int32_t >( "int32", count, iterations );
+  match &= TimeDivideFloor< itk::int64_t >( "int64", count, iterations );
+
+  return match ? EXIT_SUCCESS : EXIT_FAILURE;
+}
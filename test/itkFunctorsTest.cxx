@@ -22,9 +22,15 @@
 #include "itkDivideFloorFunctor.h"
 #include "itkDivideRealFunctor.h"
 #include "itkUnaryMinusFunctor.h"
+#include "itkStaticCastFunctor.h"
+#include "itkComposeFunctor.h"
+#include "itkRGBToLabFunctor.h"
+#include "itkRGBPixel.h"
 
 #include "gtest/gtest.h"
 
+#include <vector>
+
 
 TEST(BitwiseNotFunctorTest, Test1)
 {
@@ -46,6 +52,14 @@ TEST(BitwiseNotFunctorTest, Test1)
 
   EXPECT_EQ(0,f3(-1));
   EXPECT_EQ(-1,f3(f3(-1)));
+
+  const unsigned char input[] = {0, 1, 127, 128, 254, 255};
+  unsigned char output[6];
+  f.Evaluate(input, output, 6);
+  for ( unsigned int i = 0; i < 6; ++i )
+    {
+    EXPECT_EQ(f(input[i]), output[i]);
+    }
 }
 
 
@@ -58,6 +72,137 @@ TEST(DivideFloorFunctorTest, Test1)
 
   EXPECT_EQ(2, f(5,2));
   EXPECT_EQ(-2, f(8,-7));
+
+  // the batch evaluation matches the scalar one, zero divisors
+  // included
+  const int a[] = {5, 8, -9, 0, 7, -3, 100};
+  const int b[] = {2, -7, 4, 3, 0, 0, -1};
+  int output[7];
+  f.Evaluate(a, b, output, 7);
+  for ( unsigned int i = 0; i < 7; ++i )
+    {
+    EXPECT_EQ(f(a[i],b[i]), output[i]) << a[i] << " / " << b[i];
+    }
+}
+
+
+TEST(DivideFloorFunctorTest, Integers)
+{
+  // all the 8-bit operands, against the integer floor division
+  itk::Functor::DivFloor<signed char,signed char,int> f8;
+  for ( int a = -128; a < 128; ++a )
+    {
+    for ( int b = -128; b < 128; ++b )
+      {
+      if ( b == 0 )
+        {
+        continue;
+        }
+      const int q = a / b;
+      const int expected = ( a % b != 0 && ( ( a % b < 0 ) != ( b < 0 ) ) ) ? q - 1 : q;
+      ASSERT_EQ(expected, f8(a,b)) << a << " / " << b;
+      }
+    }
+
+  // the largest 16 and 32-bit quotients just below an integer
+  itk::Functor::DivFloor<short,short,short> f16;
+  EXPECT_EQ(0, f16(32766,32767));
+  EXPECT_EQ(-1, f16(-32766,32767));
+  EXPECT_EQ(-32767, f16(32767,-1));
+  EXPECT_EQ(32767, f16(-32767,-1));
+
+  itk::Functor::DivFloor<int,int,int> f32;
+  EXPECT_EQ(0, f32(2147483646,2147483647));
+  EXPECT_EQ(-1, f32(-2147483646,2147483647));
+  EXPECT_EQ(-2147483647, f32(2147483647,-1));
+
+  itk::Functor::DivFloor<unsigned short,short,int> fmixed;
+  EXPECT_EQ(-65535, fmixed(65535,-1));
+  EXPECT_EQ(-32768, fmixed(65535,-2));
+
+  // 64-bit integers are not exact in double
+  const itk::int64_t big = ( itk::int64_t(1) << 62 ) + 1;
+  itk::Functor::DivFloor<itk::int64_t,itk::int64_t,itk::int64_t> f64;
+  EXPECT_EQ(big, f64(big,1));
+  EXPECT_EQ(-big, f64(big,-1));
+  EXPECT_EQ(( itk::int64_t(1) << 61 ), f64(big,2));
+  EXPECT_EQ(-( itk::int64_t(1) << 61 ) - 1, f64(-big,2));
+  EXPECT_EQ(-( itk::int64_t(1) << 61 ) - 1, f64(big,-2));
+  EXPECT_EQ(( itk::int64_t(1) << 61 ), f64(-big,-2));
+
+  // the minimum divided by -1 wraps instead of trapping
+  const itk::int64_t minimum = itk::NumericTraits<itk::int64_t>::min();
+  EXPECT_EQ(minimum, f64(minimum,-1));
+  EXPECT_EQ(-( minimum + 1 ), f64(minimum + 1,-1));
+  EXPECT_EQ(( itk::int64_t(1) << 62 ), f64(minimum,-2));
+
+  const itk::uint64_t ubig = ( itk::uint64_t(1) << 63 ) + 1;
+  itk::Functor::DivFloor<itk::uint64_t,itk::uint64_t,itk::uint64_t> fu64;
+  EXPECT_EQ(ubig, fu64(ubig,1));
+  EXPECT_EQ(( itk::uint64_t(1) << 62 ), fu64(ubig,2));
+
+  const itk::int64_t a[] = {big, -big, 7, -7, 5, minimum};
+  const itk::int64_t b[] = {3, 3, -2, -2, 0, -1};
+  itk::int64_t output[6];
+  f64.Evaluate(a, b, output, 6);
+  for ( unsigned int i = 0; i < 6; ++i )
+    {
+    EXPECT_EQ(f64(a[i],b[i]), output[i]) << a[i] << " / " << b[i];
+    }
+}
+
+
+TEST(DivideFloorFunctorTest, Constant)
+{
+  // the multiply and shift division matches DivFloor
+  const int divisors[] = {1, 2, 3, 7, -1, -5, 641, 65535, -2147483647, 2147483647};
+  const int dividends[] = {0, 1, -1, 6, -6, 7, -7, 1000, -1000, 641*641, 2147483647, -2147483647-1};
+
+  itk::Functor::DivFloor<int,int,int> f;
+  for ( unsigned int i = 0; i < sizeof(divisors)/sizeof(divisors[0]); ++i )
+    {
+    itk::Functor::DivFloorByConstant<int,int,int> fc;
+    fc.SetDivisor(divisors[i]);
+    EXPECT_EQ(divisors[i], fc.GetDivisor());
+
+    for ( unsigned int j = 0; j < sizeof(dividends)/sizeof(dividends[0]); ++j )
+      {
+      if ( divisors[i] == -1 && dividends[j] == -2147483647-1 )
+        {
+        continue;
+        }
+      EXPECT_EQ(f(dividends[j],divisors[i]), fc(dividends[j])) << dividends[j] << " / " << divisors[i];
+      }
+    }
+
+  itk::Functor::DivFloorByConstant<unsigned char,unsigned char,unsigned char> f8;
+  itk::Functor::DivFloor<unsigned char,unsigned char,unsigned char>           f8ref;
+  for ( int d = 0; d < 256; ++d )
+    {
+    f8.SetDivisor(d);
+    for ( int a = 0; a < 256; ++a )
+      {
+      ASSERT_EQ(f8ref(a,d), f8(a)) << a << " / " << d;
+      }
+    }
+
+  itk::Functor::DivFloorByConstant<double,double,double> fd;
+  fd.SetDivisor(-2.0);
+  EXPECT_EQ(-3.0, fd(5.0));
+
+  itk::Functor::DivFloorByConstant<short,short,short> f16;
+  itk::Functor::DivFloorByConstant<short,short,short> f16b;
+  EXPECT_TRUE(f16 == f16b);
+  f16.SetDivisor(-3);
+  EXPECT_TRUE(f16 != f16b);
+
+  const short a[] = {-7, -6, 0, 5, 32767, -32768};
+  short output[6];
+  f16.Evaluate(a, output, 6);
+  for ( unsigned int i = 0; i < 6; ++i )
+    {
+    EXPECT_EQ(f16(a[i]), output[i]);
+    }
 }
 
 
@@ -70,6 +215,56 @@ TEST(DivideRealFunctorTest, Test1)
   EXPECT_FALSE(f!=f);
 
   EXPECT_FLOAT_EQ(2.5, f(5,2));
+
+  const int a[] = {5, -9, 0, 7};
+  const int b[] = {2, 4, 3, 0};
+  double output[4];
+  f.Evaluate(a, b, output, 4);
+  for ( unsigned int i = 0; i < 4; ++i )
+    {
+    EXPECT_EQ(f(a[i],b[i]), output[i]) << a[i] << " / " << b[i];
+    }
+}
+
+TEST(DivideRealFunctorTest, Constant)
+{
+  itk::Functor::DivReal<int,int,double>           f;
+  itk::Functor::DivRealByConstant<int,int,double> fc;
+
+  EXPECT_TRUE(fc==fc);
+  EXPECT_FALSE(fc!=fc);
+  EXPECT_DOUBLE_EQ(5.0, fc(5));
+
+  fc.SetDivisor(3);
+  EXPECT_EQ(3, fc.GetDivisor());
+
+  const int a[] = {5, -9, 0, 7, 1000000};
+  double output[5];
+  fc.Evaluate(a, output, 5);
+  for ( unsigned int i = 0; i < 5; ++i )
+    {
+    EXPECT_DOUBLE_EQ(f(a[i],3), fc(a[i]));
+    EXPECT_EQ(fc(a[i]), output[i]);
+    }
+
+  fc.SetDivisor(0);
+  EXPECT_EQ(f(5,0), fc(5));
+
+  // an integer output truncates the exact quotient, as DivReal does,
+  // although the reciprocal of 49 times 49 is below 1
+  itk::Functor::DivReal<int,int,int>           fi;
+  itk::Functor::DivRealByConstant<int,int,int> fci;
+  fci.SetDivisor(49);
+
+  const int b[] = {49, 98, -49, 48, 0, 49 * 12345};
+  int       outputInt[6];
+  fci.Evaluate(b, outputInt, 6);
+  for ( unsigned int i = 0; i < 6; ++i )
+    {
+    EXPECT_EQ(fi(b[i],49), fci(b[i])) << "Input: " << b[i];
+    EXPECT_EQ(fci(b[i]), outputInt[i]);
+    }
+  EXPECT_EQ(1, fci(49));
 }
 
 TEST(UnaryMinusFunctorTest, Test1)
@@ -82,4 +277,95 @@ TEST(UnaryMinusFunctorTest, Test1)
   EXPECT_EQ(-1.0f, f(1.0f));
   EXPECT_EQ(1.0f, f(-1.0f));
   EXPECT_EQ(0.0f, f(0.0f));
+
+  const float input[] = {1.0f, -2.5f, 0.0f};
+  float output[3];
+  f.Evaluate(input, output, 3);
+  EXPECT_EQ(-1.0f, output[0]);
+  EXPECT_EQ(2.5f, output[1]);
+  EXPECT_EQ(0.0f, output[2]);
+}
+
+TEST(RGBToLabFunctorTest, Test1)
+{
+  typedef itk::FixedArray<float,3> LabType;
+  itk::Functor::RGBToLab<itk::RGBPixel<unsigned char>, LabType> f;
+
+  EXPECT_TRUE(f==f);
+  EXPECT_FALSE(f!=f);
+
+  itk::RGBPixel<unsigned char> rgb;
+
+  rgb.Fill(0);
+  LabType lab = f(rgb);
+  EXPECT_NEAR(0.0, lab[0], 1e-4);
+  EXPECT_NEAR(0.0, lab[1], 1e-4);
+  EXPECT_NEAR(0.0, lab[2], 1e-4);
+
+  rgb.Fill(255);
+  lab = f(rgb);
+  EXPECT_NEAR(100.0, lab[0], 1e-2);
+  EXPECT_NEAR(0.0, lab[1], 1e-2);
+  EXPECT_NEAR(0.0, lab[2], 1e-2);
+
+  rgb[0] = 255;
+  rgb[1] = 0;
+  rgb[2] = 0;
+  lab = f(rgb);
+  EXPECT_NEAR(53.24, lab[0], 1e-2);
+  EXPECT_NEAR(80.09, lab[1], 1e-2);
+  EXPECT_NEAR(67.20, lab[2], 1e-2);
+
+  // floating point components are in [0,1]
+  itk::Functor::RGBToLab<itk::FixedArray<float,3>, LabType> f2;
+  itk::FixedArray<float,3> frgb;
+  frgb[0] = 1.0f;
+  frgb[1] = 0.0f;
+  frgb[2] = 0.0f;
+  LabType lab2 = f2(frgb);
+  EXPECT_NEAR(lab[0], lab2[0], 1e-4);
+  EXPECT_NEAR(lab[1], lab2[1], 1e-4);
+  EXPECT_NEAR(lab[2], lab2[2], 1e-4);
+}
+
+TEST(ComposeFunctorTest, Test1)
+{
+  typedef itk::Functor::UnaryMinus<short,short>                 MinusType;
+  typedef itk::Functor::DivRealByConstant<short,short,float>    DivideType;
+  typedef itk::Functor::StaticCast<float,unsigned char>         CastType;
+  typedef itk::Functor::BitwiseNot<unsigned char,unsigned char> NotType;
+
+  typedef itk::Functor::Compose<MinusType, DivideType>                                     MinusDivideType;
+  typedef itk::Functor::Compose<itk::Functor::Compose<MinusDivideType, CastType>, NotType> ChainType;
+
+  ChainType f;
+  ChainType f2;
+  EXPECT_TRUE(f==f2);
+
+  f.GetFirst().GetFirst().GetSecond().SetDivisor(2);
+  EXPECT_TRUE(f!=f2);
+  EXPECT_EQ(2, f.GetFirst().GetFirst().GetSecond().GetDivisor());
+
+  MinusType  minus;
+  DivideType divide;
+  divide.SetDivisor(2);
+  CastType cast;
+  NotType  bitwiseNot;
+
+  // more pixels than a block of the intermediate buffers
+  const unsigned int count = 3 * ChainType::BlockSize + 7;
+  std::vector<short>         input(count);
+  std::vector<unsigned char> output(count);
+  for ( unsigned int i = 0; i < count; ++i )
+    {
+    input[i] = -static_cast<short>( i % 500 );
+    }
+
+  f.Evaluate(&input[0], &output[0], count);
+  for ( unsigned int i = 0; i < count; ++i )
+    {
+    const unsigned char expected = bitwiseNot( cast( divide( minus( input[i] ) ) ) );
+    ASSERT_EQ(expected, f(input[i])) << input[i];
+    ASSERT_EQ(expected, output[i]) << input[i];
+    }
 }
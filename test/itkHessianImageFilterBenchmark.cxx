@@ -0,0 +1,156 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkHessianImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkTimeProbe.h"
+
+#include <cstdlib>
+#include <vector>
+
+//
+// Times HessianImageFilter on a float volume, for example:
+//   itkHessianImageFilterBenchmark 256 256 256 5
+//   itkHessianImageFilterBenchmark 512 512 512 3
+//   itkHessianImageFilterBenchmark 1024 1024 300 1
+//
+namespace
+{
+
+typedef itk::Image< float, 3 >                                      BenchmarkImageType;
+typedef itk::HessianOutputImage< BenchmarkImageType >::Type         BenchmarkHessianImageType;
+typedef itk::HessianImageFilter< BenchmarkImageType, BenchmarkHessianImageType > BenchmarkHessianFilterType;
+
+void ReportTime( const char *name, const itk::TimeProbe &probe, const BenchmarkImageType *image )
+{
+  const double voxels = static_cast< double >( image->GetLargestPossibleRegion().GetNumberOfPixels() );
+  const double seconds = probe.GetMean();
+  const double bytesPerVoxel = sizeof( BenchmarkImageType::PixelType ) + sizeof( BenchmarkHessianImageType::PixelType );
+
+  std::cout << name << ": " << seconds << " s, "
+            << 1e9 * seconds / voxels << " ns/voxel, "
+            << bytesPerVoxel * voxels / seconds / ( 1024.0 * 1024.0 * 1024.0 ) << " GB/s" << std::endl;
+}
+
+void TimeHessian( const char *name, BenchmarkHessianFilterType *filter, const BenchmarkImageType *image, unsigned int iterations )
+{
+  itk::TimeProbe probe;
+  for ( unsigned int i = 0; i < iterations; ++i )
+    {
+    filter->Modified();
+    probe.Start();
+    filter->Update();
+    probe.Stop();
+    }
+  ReportTime( name, probe, image );
+}
+
+// Exposes the N-D and the unrolled 3D stencils of the interior
+class HessianScanlineBenchmark
+  : public BenchmarkHessianFilterType
+{
+public:
+  typedef BenchmarkHessianImageType::PixelType TensorType;
+  typedef DispatchBase                         NDDispatch;
+  typedef Dispatch<3>                          UnrolledDispatch;
+
+  template< typename TDispatch >
+  static void Run( const BenchmarkImageType *image, std::vector< TensorType > &line, const TDispatch &dispatch )
+    {
+      const BenchmarkImageType::SizeType size = image->GetLargestPossibleRegion().GetSize();
+      const itk::OffsetValueType *offsetTable = image->GetOffsetTable();
+
+      const itk::OffsetValueType stride[3] = { offsetTable[0], offsetTable[1], offsetTable[2] };
+      const RealType diagonalScale[3] = { 1.0, 1.0, 1.0 };
+      const RealType crossScale[3] = { 0.25, 0.25, 0.25 };
+
+      const itk::SizeValueType length = size[0] - 2;
+      line.resize( length );
+
+      for ( itk::SizeValueType z = 1; z + 1 < size[2]; ++z )
+        {
+        for ( itk::SizeValueType y = 1; y + 1 < size[1]; ++y )
+          {
+          const float *in = image->GetBufferPointer() + z * offsetTable[2] + y * offsetTable[1] + 1;
+          ComputeHessianScanline( in, &line[0], length, stride, diagonalScale, crossScale, dispatch );
+          }
+        }
+    }
+};
+
+template< typename TDispatch >
+void TimeScanlines( const char *name, const BenchmarkImageType *image, const TDispatch &dispatch, unsigned int iterations )
+{
+  std::vector< HessianScanlineBenchmark::TensorType > line;
+
+  itk::TimeProbe probe;
+  for ( unsigned int i = 0; i < iterations; ++i )
+    {
+    probe.Start();
+    HessianScanlineBenchmark::Run( image, line, dispatch );
+    probe.Stop();
+    }
+  ReportTime( name, probe, image );
+}
+
+}
+
+int itkHessianImageFilterBenchmark( int argc, char *argv[] )
+{
+  if ( argc < 4 )
+    {
+    std::cerr << "Usage: " << argv[0] << " sizeX sizeY sizeZ [iterations]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  BenchmarkImageType::SizeType size;
+  for ( unsigned int i = 0; i < 3; ++i )
+    {
+    size[i] = atoi( argv[i+1] );
+    }
+  const unsigned int iterations = ( argc > 4 ) ? atoi( argv[4] ) : 3;
+
+  BenchmarkImageType::Pointer image = BenchmarkImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+
+  itk::ImageRegionIterator< BenchmarkImageType > it( image, image->GetLargestPossibleRegion() );
+  for ( unsigned int n = 0; !it.IsAtEnd(); ++it, ++n )
+    {
+    it.Set( static_cast< float >( ( n * 2654435761u ) % 1024 ) );
+    }
+
+  std::cout << "Image size: " << size << " iterations: " << iterations << std::endl;
+
+  BenchmarkHessianFilterType::Pointer hessian = BenchmarkHessianFilterType::New();
+  hessian->SetInput( image );
+
+  hessian->SetCacheBlockSize( 0 );
+  TimeHessian( "Slabs", hessian, image, iterations );
+
+  hessian->SetCacheBlockSize( 256*1024 );
+  TimeHessian( "Tiles 256KB", hessian, image, iterations );
+
+  hessian->SetCacheBlockSize( 1024*1024 );
+  TimeHessian( "Tiles 1MB", hessian, image, iterations );
+
+  // single threaded stencil of the interior, into a line buffer
+  TimeScanlines( "Scanline N-D", image, HessianScanlineBenchmark::NDDispatch(), iterations );
+  TimeScanlines( "Scanline 3D", image, HessianScanlineBenchmark::UnrolledDispatch(), iterations );
+
+  return EXIT_SUCCESS;
+}
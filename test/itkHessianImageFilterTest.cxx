@@ -18,6 +18,392 @@
 #include "itkHessianImageFilter.h"
 #include "itkGaussianImageSource.h"
 #include "itkImageFileReader.h"
+#include "itkStreamingImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkMath.h"
+
+namespace
+{
+
+// Central differences are exact for a quadratic, so the Hessian is
+// constant away from the image boundary.
+template< typename TImageType >
+typename TImageType::Pointer MakeQuadraticImage( unsigned int imageSize )
+{
+  const unsigned int Dimension = TImageType::ImageDimension;
+
+  typename TImageType::Pointer image = TImageType::New();
+  typename TImageType::SizeType size;
+  size.Fill( imageSize );
+  image->SetRegions( size );
+
+  typename TImageType::SpacingType spacing;
+  for ( unsigned int i = 0; i < Dimension; ++i )
+    {
+    spacing[i] = 0.5 + 0.25*i;
+    }
+  image->SetSpacing( spacing );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<TImageType> it( image, image->GetBufferedRegion() );
+  while( !it.IsAtEnd() )
+    {
+    typename TImageType::PointType pt;
+    image->TransformIndexToPhysicalPoint( it.GetIndex(), pt );
+    double v = 0.0;
+    for ( unsigned int i = 0; i < Dimension; ++i )
+      {
+      v += ( i + 1.0 ) * pt[i] * pt[i];
+      for ( unsigned int j = i + 1; j < Dimension; ++j )
+        {
+        v += ( i + 2.0*j ) * pt[i] * pt[j];
+        }
+      }
+    it.Set( v );
+    ++it;
+    }
+  return image;
+}
+
+template< typename THessianImageType >
+int CheckQuadraticHessian( const THessianImageType *hessianImage, double tolerance )
+{
+  const unsigned int Dimension = THessianImageType::ImageDimension;
+
+  typename THessianImageType::RegionType region = hessianImage->GetBufferedRegion();
+  region.ShrinkByRadius( 1 );
+
+  itk::ImageRegionConstIteratorWithIndex<THessianImageType> it( hessianImage, region );
+  while( !it.IsAtEnd() )
+    {
+    for ( unsigned int i = 0; i < Dimension; ++i )
+      {
+      for ( unsigned int j = i; j < Dimension; ++j )
+        {
+        const double expected = ( i == j ) ? 2.0*( i + 1.0 ) : ( i + 2.0*j );
+        if ( std::abs( it.Get()(i,j) - expected ) > tolerance )
+          {
+          std::cerr << "Unexpected Hessian at " << it.GetIndex() << " H(" << i << "," << j << ")="
+                    << it.Get()(i,j) << " expected " << expected << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    ++it;
+    }
+  return EXIT_SUCCESS;
+}
+
+template< unsigned int VDimension >
+int TestQuadratic( unsigned int imageSize, itk::SizeValueType cacheBlockSize = 256*1024 )
+{
+  typedef itk::Image< double, VDimension > ImageType;
+
+  typedef itk::HessianImageFilter< ImageType > HessianFilterType;
+  typename HessianFilterType::Pointer hessian = HessianFilterType::New();
+  hessian->SetInput( MakeQuadraticImage<ImageType>( imageSize ) );
+  hessian->SetCacheBlockSize( cacheBlockSize );
+  hessian->Update();
+
+  return CheckQuadraticHessian( hessian->GetOutput(), 1e-6 );
+}
+
+// The Hessian of an unnormalized Gaussian blob of sigma s0 smoothed
+// with sigma has a known value at its center.
+int TestSigma( void )
+{
+  const unsigned int Dimension = 3;
+  typedef itk::Image< float, Dimension > ImageType;
+
+  const unsigned int imageSize = 48;
+  const double       blobSigma = 8.0;
+  const double       sigma = 2.0;
+
+  ImageType::SizeType size;
+  size.Fill( imageSize );
+
+  typedef itk::GaussianImageSource<ImageType> GaussianSourceType;
+  GaussianSourceType::Pointer gaussianSource = GaussianSourceType::New();
+  gaussianSource->SetSize( size );
+  gaussianSource->SetMean( itk::FixedArray< double, Dimension>( imageSize/2 ) );
+  gaussianSource->SetSigma( itk::FixedArray< double, Dimension>( blobSigma ) );
+  gaussianSource->SetNormalized( false );
+  gaussianSource->SetScale( 1.0 );
+
+  typedef itk::HessianImageFilter< ImageType > HessianFilterType;
+  HessianFilterType::Pointer hessian = HessianFilterType::New();
+  hessian->SetInput( gaussianSource->GetOutput() );
+  hessian->SetSigma( sigma );
+  hessian->Print( std::cout );
+  hessian->Update();
+
+  ImageType::IndexType idx;
+  idx.Fill( imageSize/2 );
+  const HessianFilterType::OutputPixelType H = hessian->GetOutput()->GetPixel( idx );
+
+  // central difference of the smoothed blob at the center
+  const double s2 = blobSigma*blobSigma + sigma*sigma;
+  const double amplitude = std::pow( blobSigma*blobSigma/s2, 0.5*Dimension );
+  const double expected = 2.0 * amplitude * ( std::exp( -0.5/s2 ) - 1.0 );
+
+  for ( unsigned int i = 0; i < Dimension; ++i )
+    {
+    if ( std::abs( H(i,i) - expected ) > 1e-3 * std::abs( expected ) )
+      {
+      std::cerr << "Unexpected smoothed Hessian H(" << i << "," << i << ")=" << H(i,i)
+                << " expected " << expected << std::endl;
+      return EXIT_FAILURE;
+      }
+    for ( unsigned int j = i + 1; j < Dimension; ++j )
+      {
+      if ( std::abs( H(i,j) ) > 1e-6 )
+        {
+        std::cerr << "Unexpected smoothed Hessian H(" << i << "," << j << ")=" << H(i,j) << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // streaming and threading must produce the same result
+  HessianFilterType::Pointer hessian2 = HessianFilterType::New();
+  hessian2->SetInput( gaussianSource->GetOutput() );
+  hessian2->SetSigma( sigma );
+  hessian2->SetNumberOfThreads( 1 );
+
+  typedef itk::StreamingImageFilter< HessianFilterType::OutputImageType, HessianFilterType::OutputImageType > StreamingFilterType;
+  StreamingFilterType::Pointer streamer = StreamingFilterType::New();
+  streamer->SetInput( hessian2->GetOutput() );
+  streamer->SetNumberOfStreamDivisions( 5 );
+  streamer->Update();
+
+  typedef itk::ImageRegionConstIteratorWithIndex< HessianFilterType::OutputImageType > IteratorType;
+  IteratorType it1( hessian->GetOutput(), hessian->GetOutput()->GetBufferedRegion() );
+  IteratorType it2( streamer->GetOutput(), streamer->GetOutput()->GetBufferedRegion() );
+  while ( !it1.IsAtEnd() )
+    {
+    for ( unsigned int k = 0; k < HessianFilterType::OutputPixelType::Length; ++k )
+      {
+      if ( std::abs( it1.Get()[k] - it2.Get()[k] ) > 1e-10 )
+        {
+        std::cerr << "Streamed smoothed Hessian differs at " << it1.GetIndex() << ": "
+                  << it1.Get() << " " << it2.Get() << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    ++it1;
+    ++it2;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+// The float output should only differ from the double output by the
+// rounding of the components.
+int TestFloatOutput( double sigma )
+{
+  const unsigned int Dimension = 3;
+  typedef itk::Image< short, Dimension > ImageType;
+
+  const unsigned int imageSize = 32;
+
+  ImageType::SizeType size;
+  size.Fill( imageSize );
+
+  typedef itk::GaussianImageSource<ImageType> GaussianSourceType;
+  GaussianSourceType::Pointer gaussianSource = GaussianSourceType::New();
+  gaussianSource->SetSize( size );
+  gaussianSource->SetMean( itk::FixedArray< double, Dimension>( imageSize/2 ) );
+  gaussianSource->SetSigma( itk::FixedArray< double, Dimension>( 5.0 ) );
+  gaussianSource->SetNormalized( false );
+  gaussianSource->SetScale( 1000.0 );
+
+  typedef itk::HessianImageFilter< ImageType > DoubleHessianFilterType;
+  DoubleHessianFilterType::Pointer doubleHessian = DoubleHessianFilterType::New();
+  doubleHessian->SetInput( gaussianSource->GetOutput() );
+  doubleHessian->SetSigma( sigma );
+  doubleHessian->Update();
+
+  typedef itk::HessianOutputImage< ImageType >::Type                  FloatHessianImageType;
+  typedef itk::HessianImageFilter< ImageType, FloatHessianImageType > FloatHessianFilterType;
+  FloatHessianFilterType::Pointer floatHessian = FloatHessianFilterType::New();
+  floatHessian->SetInput( gaussianSource->GetOutput() );
+  floatHessian->SetSigma( sigma );
+  floatHessian->Update();
+
+  std::cout << "Hessian pixel size double: " << sizeof( DoubleHessianFilterType::OutputPixelType )
+            << " float: " << sizeof( FloatHessianFilterType::OutputPixelType ) << std::endl;
+
+  typedef itk::ImageRegionConstIteratorWithIndex< DoubleHessianFilterType::OutputImageType > DoubleIteratorType;
+  typedef itk::ImageRegionConstIteratorWithIndex< FloatHessianImageType >                    FloatIteratorType;
+  DoubleIteratorType dit( doubleHessian->GetOutput(), doubleHessian->GetOutput()->GetBufferedRegion() );
+  FloatIteratorType  fit( floatHessian->GetOutput(), floatHessian->GetOutput()->GetBufferedRegion() );
+  while ( !dit.IsAtEnd() )
+    {
+    for ( unsigned int k = 0; k < FloatHessianFilterType::OutputPixelType::Length; ++k )
+      {
+      const double d = dit.Get()[k];
+      if ( std::abs( fit.Get()[k] - d ) > 1e-6 * std::abs( d ) + 1e-12 )
+        {
+        std::cerr << "Float Hessian differs at " << dit.GetIndex() << ": "
+                  << fit.Get() << " " << dit.Get() << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    ++dit;
+    ++fit;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+// The eigenvalues computed by the filter must match the eigenvalues of
+// the tensor output.
+int TestEigenValuesOutput( double sigma )
+{
+  const unsigned int Dimension = 3;
+  typedef itk::Image< float, Dimension > ImageType;
+
+  const unsigned int imageSize = 24;
+
+  ImageType::SizeType size;
+  size.Fill( imageSize );
+
+  typedef itk::GaussianImageSource<ImageType> GaussianSourceType;
+  GaussianSourceType::Pointer gaussianSource = GaussianSourceType::New();
+  gaussianSource->SetSize( size );
+  gaussianSource->SetMean( itk::FixedArray< double, Dimension>( imageSize/2 - 1.5 ) );
+  gaussianSource->SetSigma( itk::FixedArray< double, Dimension>( 4.0 ) );
+  gaussianSource->SetNormalized( false );
+  gaussianSource->SetScale( 100.0 );
+
+  typedef itk::HessianImageFilter< ImageType > HessianFilterType;
+  HessianFilterType::Pointer hessian = HessianFilterType::New();
+  hessian->SetInput( gaussianSource->GetOutput() );
+  hessian->SetSigma( sigma );
+  hessian->Update();
+
+  typedef itk::HessianEigenValuesOutputImage< ImageType, double >::Type   EigenValuesImageType;
+  typedef itk::HessianImageFilter< ImageType, EigenValuesImageType >      EigenValuesFilterType;
+  EigenValuesFilterType::Pointer eigenValues = EigenValuesFilterType::New();
+  eigenValues->SetInput( gaussianSource->GetOutput() );
+  eigenValues->SetSigma( sigma );
+  eigenValues->Update();
+
+  typedef itk::ImageRegionConstIteratorWithIndex< HessianFilterType::OutputImageType > HessianIteratorType;
+  typedef itk::ImageRegionConstIteratorWithIndex< EigenValuesImageType >               EigenValuesIteratorType;
+  HessianIteratorType     hit( hessian->GetOutput(), hessian->GetOutput()->GetBufferedRegion() );
+  EigenValuesIteratorType eit( eigenValues->GetOutput(), eigenValues->GetOutput()->GetBufferedRegion() );
+  HessianFilterType::OutputPixelType::EigenValuesArrayType expected;
+  while ( !hit.IsAtEnd() )
+    {
+    hit.Get().ComputeEigenValues( expected );
+    for ( unsigned int i = 0; i < Dimension; ++i )
+      {
+      if ( std::abs( eit.Get()[i] - expected[i] ) > 1e-10 )
+        {
+        std::cerr << "Eigenvalues differ at " << hit.GetIndex() << ": "
+                  << eit.Get() << " " << expected << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    ++hit;
+    ++eit;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+// The sparse evaluation must match the dense output, including at the
+// boundary of the image.
+template< typename TOutputImage >
+int TestSparse( double sigma )
+{
+  const unsigned int Dimension = 3;
+  typedef itk::Image< float, Dimension > ImageType;
+
+  ImageType::SizeType size;
+  size[0] = 19;
+  size[1] = 14;
+  size[2] = 11;
+
+  ImageType::SpacingType spacing;
+  spacing[0] = 1.0;
+  spacing[1] = 0.75;
+  spacing[2] = 1.5;
+
+  typedef itk::GaussianImageSource<ImageType> GaussianSourceType;
+  GaussianSourceType::Pointer gaussianSource = GaussianSourceType::New();
+  gaussianSource->SetSize( size );
+  gaussianSource->SetSpacing( spacing );
+  gaussianSource->SetMean( itk::FixedArray< double, Dimension>( 6.0 ) );
+  gaussianSource->SetSigma( itk::FixedArray< double, Dimension>( 3.0 ) );
+  gaussianSource->SetNormalized( false );
+  gaussianSource->SetScale( 100.0 );
+  gaussianSource->Update();
+
+  typedef itk::HessianImageFilter< ImageType, TOutputImage > HessianFilterType;
+  typename HessianFilterType::Pointer hessian = HessianFilterType::New();
+  hessian->SetInput( gaussianSource->GetOutput() );
+  hessian->SetSigma( sigma );
+  hessian->Update();
+
+  typedef itk::Image< unsigned char, Dimension > MaskImageType;
+  MaskImageType::Pointer mask = MaskImageType::New();
+  mask->CopyInformation( gaussianSource->GetOutput() );
+  mask->SetRegions( gaussianSource->GetOutput()->GetLargestPossibleRegion() );
+  mask->Allocate();
+  mask->FillBuffer( 0 );
+
+  typename HessianFilterType::IndexListType indices;
+  itk::ImageRegionIteratorWithIndex< MaskImageType > mit( mask, mask->GetLargestPossibleRegion() );
+  for ( unsigned int n = 0; !mit.IsAtEnd(); ++mit, ++n )
+    {
+    if ( n % 7 == 0 )
+      {
+      mit.Set( 1 );
+      indices.push_back( mit.GetIndex() );
+      }
+    }
+
+  typename HessianFilterType::Pointer sparse = HessianFilterType::New();
+  sparse->SetInput( gaussianSource->GetOutput() );
+  sparse->SetSigma( sigma );
+
+  typename HessianFilterType::OutputPixelListType indexValues;
+  sparse->EvaluateAtIndices( indices, indexValues );
+
+  typename HessianFilterType::IndexListType       maskIndices;
+  typename HessianFilterType::OutputPixelListType maskValues;
+  sparse->EvaluateAtMask( mask.GetPointer(), maskIndices, maskValues );
+
+  if ( maskIndices != indices || maskValues.size() != indices.size() )
+    {
+    std::cerr << "EvaluateAtMask returned different indices than the mask" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int length = itk::NumericTraits< typename HessianFilterType::OutputPixelType >::GetLength(
+    hessian->GetOutput()->GetPixel( indices[0] ) );
+  for ( size_t n = 0; n < indices.size(); ++n )
+    {
+    const typename HessianFilterType::OutputPixelType expected = hessian->GetOutput()->GetPixel( indices[n] );
+    for ( unsigned int k = 0; k < length; ++k )
+      {
+      if ( std::abs( indexValues[n][k] - expected[k] ) > 1e-6 * std::abs( expected[k] ) + 1e-9
+           || std::abs( maskValues[n][k] - expected[k] ) > 1e-6 * std::abs( expected[k] ) + 1e-9 )
+        {
+        std::cerr << "Sparse evaluation with sigma " << sigma << " differs at " << indices[n] << ": "
+                  << indexValues[n] << " " << maskValues[n] << " " << expected << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
+
+}
 
 int itkHessianImageFilterTest( int , char *[] )
 {
@@ -60,5 +446,20 @@ int itkHessianImageFilterTest( int , char *[] )
   --idx[1];
   std::cout << hessian->GetOutput()->GetPixel( idx )  << std::endl;
 
+  if ( TestQuadratic<2>( 32 ) == EXIT_FAILURE
+       || TestQuadratic<3>( 17 ) == EXIT_FAILURE
+       || TestQuadratic<3>( 23, 1024 ) == EXIT_FAILURE
+       || TestSigma() == EXIT_FAILURE
+       || TestFloatOutput( 0.0 ) == EXIT_FAILURE
+       || TestFloatOutput( 1.5 ) == EXIT_FAILURE
+       || TestEigenValuesOutput( 0.0 ) == EXIT_FAILURE
+       || TestEigenValuesOutput( 1.5 ) == EXIT_FAILURE
+       || TestSparse< itk::Image< itk::SymmetricSecondRankTensor< double, 3 >, 3 > >( 0.0 ) == EXIT_FAILURE
+       || TestSparse< itk::Image< itk::SymmetricSecondRankTensor< double, 3 >, 3 > >( 2.0 ) == EXIT_FAILURE
+       || TestSparse< itk::HessianEigenValuesOutputImage< itk::Image< float, 3 > >::Type >( 1.0 ) == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+
   return 0;
 }
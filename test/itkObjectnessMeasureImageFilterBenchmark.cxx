@@ -0,0 +1,113 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkSymmetricEigenValuesClosedForm.h"
+#include "itkSymmetricSecondRankTensor.h"
+#include "itkTimeProbe.h"
+
+#include <cstdlib>
+#include <vector>
+
+//
+// Times the eigenvalues of the objectness, for example:
+//   itkObjectnessMeasureImageFilterBenchmark 10000000 5
+//
+namespace
+{
+
+void ReportThroughput( const char *name, const itk::TimeProbe &probe, unsigned int count, double checksum )
+{
+  const double seconds = probe.GetMean();
+
+  std::cout << name << ": " << seconds << " s, "
+            << 1e9 * seconds / count << " ns/tensor, "
+            << 1e-6 * count / seconds << " Mtensors/s"
+            << " (checksum " << checksum << ")" << std::endl;
+}
+
+template< unsigned int VDimension >
+void TimeEigenValues( unsigned int count, unsigned int iterations )
+{
+  typedef itk::SymmetricSecondRankTensor< double, VDimension >      TensorType;
+  typedef typename TensorType::EigenValuesArrayType                 EigenValuesArrayType;
+  typedef itk::SymmetricEigenValuesClosedForm< double, VDimension > ClosedFormType;
+
+  std::vector< TensorType > tensors( count );
+  unsigned int state = 1;
+  for ( unsigned int n = 0; n < count; ++n )
+    {
+    for ( unsigned int k = 0; k < TensorType::Length; ++k )
+      {
+      state = state * 1664525u + 1013904223u;
+      tensors[n][k] = state / 2147483648.0 - 1.0;
+      }
+    }
+
+  std::vector< EigenValuesArrayType > eigenValues( count );
+
+  std::cout << VDimension << "D, " << count << " tensors" << std::endl;
+
+  itk::TimeProbe iterativeProbe;
+  double         checksum = 0.0;
+  for ( unsigned int i = 0; i < iterations; ++i )
+    {
+    iterativeProbe.Start();
+    for ( unsigned int n = 0; n < count; ++n )
+      {
+      tensors[n].ComputeEigenValues( eigenValues[n] );
+      }
+    iterativeProbe.Stop();
+    checksum += eigenValues[count/2][0];
+    }
+  ReportThroughput( "  SymmetricEigenAnalysis", iterativeProbe, count, checksum );
+
+  itk::TimeProbe closedFormProbe;
+  checksum = 0.0;
+  for ( unsigned int i = 0; i < iterations; ++i )
+    {
+    closedFormProbe.Start();
+    ClosedFormType::ComputeEigenValues( tensors[0].GetDataPointer(), eigenValues[0].GetDataPointer(), count );
+    closedFormProbe.Stop();
+    checksum += eigenValues[count/2][0];
+    }
+  ReportThroughput( "  SymmetricEigenValuesClosedForm", closedFormProbe, count, checksum );
+}
+
+}
+
+int itkObjectnessMeasureImageFilterBenchmark( int argc, char *argv[] )
+{
+  if ( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " numberOfTensors [iterations]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int count = atoi( argv[1] );
+  const unsigned int iterations = ( argc > 2 ) ? atoi( argv[2] ) : 3;
+
+  if ( count == 0 )
+    {
+    std::cerr << "The number of tensors must be positive" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  TimeEigenValues<2>( count, iterations );
+  TimeEigenValues<3>( count, iterations );
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,503 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkObjectnessMeasureImageFilter.h"
+#include "itkHessianImageFilter.h"
+#include "itkHessianToObjectnessMeasureImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkStreamingImageFilter.h"
+#include "itkCommand.h"
+
+namespace
+{
+
+const unsigned int Dimension = 3;
+typedef itk::Image< double, Dimension > ImageType;
+
+// a bright tube along x and a dark blob on a noisy background
+ImageType::Pointer MakeTubeImage( void )
+{
+  ImageType::SizeType size;
+  size[0] = 24;
+  size[1] = 20;
+  size[2] = 18;
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for ( unsigned int n = 0; !it.IsAtEnd(); ++it, ++n )
+    {
+    const ImageType::IndexType idx = it.GetIndex();
+    const double ty = idx[1] - 7.0;
+    const double tz = idx[2] - 9.0;
+    const double bx = idx[0] - 17.0;
+    const double by = idx[1] - 13.0;
+    const double bz = idx[2] - 8.0;
+    it.Set( 100.0 * std::exp( -( ty*ty + tz*tz ) / 8.0 )
+            - 80.0 * std::exp( -( bx*bx + by*by + bz*bz ) / 12.0 )
+            + ( ( n * 2654435761u ) % 97 ) / 97.0 );
+    }
+  return image;
+}
+
+int CompareWithHessianToObjectness( unsigned int objectDimension, bool brightObject, bool scaleObjectness )
+{
+  ImageType::Pointer image = MakeTubeImage();
+
+  typedef itk::ObjectnessMeasureImageFilter< ImageType, ImageType > FilterType;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( image );
+  filter->SetAlpha( 0.5 );
+  filter->SetBeta( 0.5 );
+  filter->SetGamma( 5.0 );
+  filter->SetObjectDimension( objectDimension );
+  filter->SetBrightObject( brightObject );
+  filter->SetScaleObjectnessMeasure( scaleObjectness );
+  filter->Update();
+
+  typedef itk::HessianImageFilter< ImageType > HessianFilterType;
+  HessianFilterType::Pointer hessian = HessianFilterType::New();
+  hessian->SetInput( image );
+
+  typedef itk::HessianToObjectnessMeasureImageFilter< HessianFilterType::OutputImageType, ImageType > ObjectnessFilterType;
+  ObjectnessFilterType::Pointer objectness = ObjectnessFilterType::New();
+  objectness->SetInput( hessian->GetOutput() );
+  objectness->SetAlpha( 0.5 );
+  objectness->SetBeta( 0.5 );
+  objectness->SetGamma( 5.0 );
+  objectness->SetObjectDimension( objectDimension );
+  objectness->SetBrightObject( brightObject );
+  objectness->SetScaleObjectnessMeasure( scaleObjectness );
+  objectness->Update();
+
+  itk::ImageRegionConstIteratorWithIndex< ImageType > fit( filter->GetOutput(), filter->GetOutput()->GetBufferedRegion() );
+  itk::ImageRegionConstIteratorWithIndex< ImageType > oit( objectness->GetOutput(), objectness->GetOutput()->GetBufferedRegion() );
+  unsigned int nonZero = 0;
+  while ( !fit.IsAtEnd() )
+    {
+    // the closed form eigenvalues differ from SymmetricEigenAnalysis
+    // by up to about 1e-8 of the norm of the Hessian
+    if ( std::abs( fit.Get() - oit.Get() ) > 1e-6 * ( 1.0 + std::abs( oit.Get() ) ) )
+      {
+      std::cerr << "Objectness differs at " << fit.GetIndex() << ": "
+                << fit.Get() << " " << oit.Get() << std::endl;
+      return EXIT_FAILURE;
+      }
+    if ( fit.Get() != 0.0 )
+      {
+      ++nonZero;
+      }
+    ++fit;
+    ++oit;
+    }
+
+  std::cout << "ObjectDimension: " << objectDimension << " BrightObject: " << brightObject
+            << " ScaleObjectnessMeasure: " << scaleObjectness << " non-zero pixels: " << nonZero << std::endl;
+
+  return EXIT_SUCCESS;
+}
+
+// Streaming must compute the same objectness from padded input regions
+int TestStreaming( void )
+{
+  ImageType::Pointer image = MakeTubeImage();
+
+  typedef itk::ObjectnessMeasureImageFilter< ImageType, ImageType > FilterType;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( image );
+  filter->SetObjectDimension( 1 );
+  filter->Update();
+
+  ImageType::Pointer expected = filter->GetOutput();
+  expected->DisconnectPipeline();
+
+  typedef itk::StreamingImageFilter< ImageType, ImageType > StreamingFilterType;
+  StreamingFilterType::Pointer streamer = StreamingFilterType::New();
+  streamer->SetInput( filter->GetOutput() );
+  streamer->SetNumberOfStreamDivisions( 7 );
+  streamer->Update();
+
+  if ( filter->GetOutput()->GetBufferedRegion() == image->GetLargestPossibleRegion() )
+    {
+    std::cerr << "The last stream was computed over the largest possible region" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  itk::ImageRegionConstIteratorWithIndex< ImageType > eit( expected, expected->GetBufferedRegion() );
+  itk::ImageRegionConstIteratorWithIndex< ImageType > sit( streamer->GetOutput(), streamer->GetOutput()->GetBufferedRegion() );
+  while ( !eit.IsAtEnd() )
+    {
+    if ( std::abs( eit.Get() - sit.Get() ) > 1e-12 * ( 1.0 + std::abs( eit.Get() ) ) )
+      {
+      std::cerr << "Streamed objectness differs at " << eit.GetIndex() << ": "
+                << sit.Get() << " " << eit.Get() << std::endl;
+      return EXIT_FAILURE;
+      }
+    ++eit;
+    ++sit;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+// The multiscale mode must be the maximum of the single scales with
+// the Hessian normalized by sigma^2, which is the single scale of the
+// input multiplied by sigma^2.
+int TestMultiScale( void )
+{
+  ImageType::Pointer image = MakeTubeImage();
+
+  typedef itk::ObjectnessMeasureImageFilter< ImageType, ImageType > FilterType;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( image );
+  filter->SetSigmaMinimum( 0.5 );
+  filter->SetSigmaMaximum( 2.0 );
+  filter->SetNumberOfSigmaSteps( 3 );
+  filter->GenerateScalesOutputOn();
+  filter->Update();
+
+  ImageType::Pointer maximum = ImageType::New();
+  maximum->SetRegions( image->GetLargestPossibleRegion() );
+  maximum->Allocate();
+  maximum->FillBuffer( 0.0 );
+
+  ImageType::Pointer secondMaximum = ImageType::New();
+  secondMaximum->SetRegions( image->GetLargestPossibleRegion() );
+  secondMaximum->Allocate();
+  secondMaximum->FillBuffer( 0.0 );
+
+  FilterType::ScalesImageType::Pointer scales = FilterType::ScalesImageType::New();
+  scales->SetRegions( image->GetLargestPossibleRegion() );
+  scales->Allocate();
+
+  const double sigmas[3] = { 0.5, 1.0, 2.0 };
+  for ( unsigned int k = 0; k < 3; ++k )
+    {
+    if ( std::abs( filter->ComputeSigma( k ) - sigmas[k] ) > 1e-12 )
+      {
+      std::cerr << "Scale " << k << " is " << filter->ComputeSigma( k ) << " instead of " << sigmas[k] << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    ImageType::Pointer scaled = ImageType::New();
+    scaled->SetRegions( image->GetLargestPossibleRegion() );
+    scaled->Allocate();
+    itk::ImageRegionConstIteratorWithIndex< ImageType > iit( image, image->GetLargestPossibleRegion() );
+    itk::ImageRegionIteratorWithIndex< ImageType >      sit( scaled, scaled->GetLargestPossibleRegion() );
+    for ( ; !iit.IsAtEnd(); ++iit, ++sit )
+      {
+      sit.Set( iit.Get() * sigmas[k] * sigmas[k] );
+      }
+
+    // the same sigma as the multiscale filter, for the same kernel radius
+    FilterType::Pointer single = FilterType::New();
+    single->SetInput( scaled );
+    single->SetSigma( filter->ComputeSigma( k ) );
+    single->Update();
+
+    itk::ImageRegionConstIteratorWithIndex< ImageType > oit( single->GetOutput(), single->GetOutput()->GetBufferedRegion() );
+    for ( ; !oit.IsAtEnd(); ++oit )
+      {
+      const ImageType::IndexType idx = oit.GetIndex();
+      if ( k == 0 || oit.Get() > maximum->GetPixel( idx ) )
+        {
+        secondMaximum->SetPixel( idx, maximum->GetPixel( idx ) );
+        maximum->SetPixel( idx, oit.Get() );
+        scales->SetPixel( idx, sigmas[k] );
+        }
+      else if ( oit.Get() > secondMaximum->GetPixel( idx ) )
+        {
+        secondMaximum->SetPixel( idx, oit.Get() );
+        }
+      }
+    }
+
+  itk::ImageRegionConstIteratorWithIndex< ImageType > mit( maximum, maximum->GetLargestPossibleRegion() );
+  for ( ; !mit.IsAtEnd(); ++mit )
+    {
+    const ImageType::IndexType idx = mit.GetIndex();
+    const double tolerance = 1e-6 * ( 1.0 + std::abs( mit.Get() ) );
+    if ( std::abs( filter->GetOutput()->GetPixel( idx ) - mit.Get() ) > tolerance )
+      {
+      std::cerr << "Multiscale objectness differs at " << idx << ": "
+                << filter->GetOutput()->GetPixel( idx ) << " " << mit.Get() << std::endl;
+      return EXIT_FAILURE;
+      }
+    if ( mit.Get() - secondMaximum->GetPixel( idx ) > tolerance
+         && filter->GetScalesOutput()->GetPixel( idx ) != scales->GetPixel( idx ) )
+      {
+      std::cerr << "Scale of the maximum differs at " << idx << ": "
+                << filter->GetScalesOutput()->GetPixel( idx ) << " " << scales->GetPixel( idx ) << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
+
+// Pixels with a Hessian norm below the threshold must be 0, and the
+// others unchanged.
+int TestHessianNormThreshold( void )
+{
+  ImageType::Pointer image = MakeTubeImage();
+
+  typedef itk::ObjectnessMeasureImageFilter< ImageType, ImageType > FilterType;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( image );
+  filter->SetGamma( 20.0 );
+  filter->Update();
+
+  ImageType::Pointer expected = filter->GetOutput();
+  expected->DisconnectPipeline();
+
+  if ( filter->GetFractionOfSkippedPixels() != 0.0 )
+    {
+    std::cerr << "Pixels were skipped without a threshold" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const double threshold = 2.0;
+  filter->SetHessianNormThreshold( threshold );
+  filter->Update();
+
+  typedef itk::HessianImageFilter< ImageType > HessianFilterType;
+  HessianFilterType::Pointer hessian = HessianFilterType::New();
+  hessian->SetInput( image );
+  hessian->Update();
+
+  unsigned int numberOfFlatPixels = 0;
+  itk::ImageRegionConstIteratorWithIndex< ImageType > eit( expected, expected->GetBufferedRegion() );
+  for ( ; !eit.IsAtEnd(); ++eit )
+    {
+    const ImageType::IndexType idx = eit.GetIndex();
+    const double norm = std::sqrt( FilterType::FrobeniusNormSquared( hessian->GetOutput()->GetPixel( idx ) ) );
+    const double value = filter->GetOutput()->GetPixel( idx );
+    if ( norm < threshold )
+      {
+      ++numberOfFlatPixels;
+      if ( value != 0.0 )
+        {
+        std::cerr << "Flat pixel " << idx << " with norm " << norm << " is " << value << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    else if ( value != eit.Get() )
+      {
+      std::cerr << "Objectness above the threshold differs at " << idx << ": "
+                << value << " " << eit.Get() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  const double fraction = static_cast< double >( numberOfFlatPixels ) / expected->GetBufferedRegion().GetNumberOfPixels();
+  std::cout << "Skipped fraction: " << filter->GetFractionOfSkippedPixels() << std::endl;
+  if ( numberOfFlatPixels == 0 || std::abs( filter->GetFractionOfSkippedPixels() - fraction ) > 1e-12 )
+    {
+    std::cerr << "Expected a skipped fraction of " << fraction << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+// Records the progress of a filter
+class ProgressRecorder
+  : public itk::Command
+{
+public:
+  typedef ProgressRecorder          Self;
+  typedef itk::Command              Superclass;
+  typedef itk::SmartPointer< Self > Pointer;
+
+  itkNewMacro(Self);
+
+  void Execute( itk::Object *caller, const itk::EventObject & event ) ITK_OVERRIDE
+    {
+      this->Execute( const_cast< const itk::Object * >( caller ), event );
+    }
+
+  void Execute( const itk::Object *caller, const itk::EventObject & ) ITK_OVERRIDE
+    {
+      m_Progress.push_back( static_cast< const itk::ProcessObject * >( caller )->GetProgress() );
+    }
+
+  std::vector< float > m_Progress;
+};
+
+// The scales must be positive, and the progress must not restart at
+// each scale
+int TestMultiScaleParameters( void )
+{
+  ImageType::Pointer image = MakeTubeImage();
+
+  typedef itk::ObjectnessMeasureImageFilter< ImageType, ImageType > FilterType;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( image );
+  filter->SetSigmaMinimum( 0.0 );
+  filter->SetSigmaMaximum( 2.0 );
+  filter->SetNumberOfSigmaSteps( 3 );
+
+  bool thrown = false;
+  try
+    {
+    filter->Update();
+    }
+  catch ( itk::ExceptionObject & )
+    {
+    thrown = true;
+    }
+  if ( !thrown )
+    {
+    std::cerr << "A SigmaMinimum of 0 with 3 scales did not throw" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ProgressRecorder::Pointer recorder = ProgressRecorder::New();
+  filter->AddObserver( itk::ProgressEvent(), recorder );
+  filter->SetSigmaMinimum( 0.5 );
+  filter->Update();
+
+  for ( size_t i = 1; i < recorder->m_Progress.size(); ++i )
+    {
+    if ( recorder->m_Progress[i] < recorder->m_Progress[i-1] )
+      {
+      std::cerr << "The progress went back from " << recorder->m_Progress[i-1] << " to "
+                << recorder->m_Progress[i] << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if ( recorder->m_Progress.empty() || recorder->m_Progress.back() != 1.0f )
+    {
+    std::cerr << "The progress did not end at 1" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+// the masked objectness is the objectness inside the mask and 0 outside
+int TestMask( double sigma, unsigned int numberOfSigmaSteps )
+{
+  ImageType::Pointer image = MakeTubeImage();
+
+  typedef itk::ObjectnessMeasureImageFilter< ImageType, ImageType > FilterType;
+  typedef FilterType::MaskImageType                                 MaskImageType;
+
+  // a slab around the tube with a hole, and scattered pixels
+  MaskImageType::Pointer mask = MaskImageType::New();
+  mask->CopyInformation( image );
+  mask->SetRegions( image->GetLargestPossibleRegion() );
+  mask->Allocate();
+
+  unsigned int numberOfMaskedPixels = 0;
+  itk::ImageRegionIteratorWithIndex< MaskImageType > mit( mask, mask->GetLargestPossibleRegion() );
+  for ( unsigned int n = 0; !mit.IsAtEnd(); ++mit, ++n )
+    {
+    const MaskImageType::IndexType idx = mit.GetIndex();
+    const bool slab = idx[1] >= 4 && idx[1] <= 11 && ( idx[0] < 10 || idx[0] > 13 );
+    const bool scattered = ( n * 2654435761u ) % 13 == 0;
+    mit.Set( ( slab || scattered ) ? 1 : 0 );
+    numberOfMaskedPixels += mit.Get();
+    }
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( image );
+  filter->SetSigma( sigma );
+  filter->SetSigmaMinimum( 0.5 );
+  filter->SetSigmaMaximum( 2.0 );
+  filter->SetNumberOfSigmaSteps( numberOfSigmaSteps );
+  filter->GenerateScalesOutputOn();
+  filter->Update();
+
+  ImageType::Pointer expected = filter->GetOutput();
+  expected->DisconnectPipeline();
+
+  filter->SetMaskImage( mask );
+  filter->Update();
+
+  if ( filter->GetMaskImage() != mask.GetPointer() )
+    {
+    std::cerr << "The mask image was not set" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  itk::ImageRegionConstIteratorWithIndex< ImageType > eit( expected, expected->GetBufferedRegion() );
+  for ( ; !eit.IsAtEnd(); ++eit )
+    {
+    const ImageType::IndexType idx = eit.GetIndex();
+    const double value = filter->GetOutput()->GetPixel( idx );
+    const double expectedValue = mask->GetPixel( idx ) ? eit.Get() : 0.0;
+    if ( std::abs( value - expectedValue ) > 1e-10 )
+      {
+      std::cerr << "Masked objectness with sigma " << sigma << " and " << numberOfSigmaSteps
+                << " scales differs at " << idx << ": " << value << " " << expectedValue << std::endl;
+      return EXIT_FAILURE;
+      }
+    if ( !mask->GetPixel( idx ) && filter->GetScalesOutput()->GetPixel( idx ) != 0.0 )
+      {
+      std::cerr << "The scale outside the mask is not 0 at " << idx << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // with a threshold above every norm, all the evaluated pixels, the
+  // masked ones, are skipped
+  filter->SetHessianNormThreshold( 1e100 );
+  filter->Update();
+  if ( filter->GetFractionOfSkippedPixels() != 1.0 )
+    {
+    std::cerr << "Skipped fraction of the masked pixels is " << filter->GetFractionOfSkippedPixels()
+              << " instead of 1" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Masked " << numberOfMaskedPixels << " of "
+            << mask->GetLargestPossibleRegion().GetNumberOfPixels() << " pixels" << std::endl;
+
+  return EXIT_SUCCESS;
+}
+
+}
+
+int itkObjectnessMeasureImageFilterFusedTest( int , char *[] )
+{
+  for ( unsigned int objectDimension = 0; objectDimension < Dimension; ++objectDimension )
+    {
+    if ( CompareWithHessianToObjectness( objectDimension, true, false ) == EXIT_FAILURE
+         || CompareWithHessianToObjectness( objectDimension, false, true ) == EXIT_FAILURE )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  if ( TestStreaming() == EXIT_FAILURE
+       || TestMultiScale() == EXIT_FAILURE
+       || TestMultiScaleParameters() == EXIT_FAILURE
+       || TestHessianNormThreshold() == EXIT_FAILURE
+       || TestMask( 0.0, 0 ) == EXIT_FAILURE
+       || TestMask( 1.0, 0 ) == EXIT_FAILURE
+       || TestMask( 0.0, 3 ) == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -23,11 +23,42 @@
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 
+namespace
+{
+
+template< typename TFilter, typename TImage >
+typename TImage::Pointer
+ComputeObjectness( const TImage *input, unsigned int objectDimension, bool brightObject )
+{
+  const double alphaValue = 0.5;
+  const double betaValue = 0.5;
+  const double gammaValue = 0.5;
+
+  typename TFilter::Pointer filter =  TFilter::New();
+  filter->SetInput(input);
+  filter->SetAlpha(alphaValue);
+  filter->SetBeta(betaValue);
+  filter->SetGamma(gammaValue);
+  filter->SetBrightObject(brightObject);
+  filter->SetObjectDimension(objectDimension);
+  filter->SetScaleObjectnessMeasure(false);
+
+  FilterWatcher watcher(filter);
+
+  filter->Update();
+
+  typename TImage::Pointer output = filter->GetOutput();
+  output->DisconnectPipeline();
+  return output;
+}
+
+}
+
 int itkObjectnessMeasureImageFilterTest(int argc, char *argv[])
 {
   if( argc < 3 )
     {
-    std::cerr << "Usage: " << argv[0] << " inputImage outputImage [ObjectDimension] [Bright/Dark]" << std::endl;
+    std::cerr << "Usage: " << argv[0] << " inputImage outputImage [ObjectDimension] [Bright/Dark] [FloatPrecision]" << std::endl;
     return EXIT_FAILURE;
     }
   const char *inputImageFileName = argv[1];
@@ -35,9 +66,7 @@ int itkObjectnessMeasureImageFilterTest(int argc, char *argv[])
 
   const unsigned int objectDimension = (argc >= 3) ? atoi(argv[3]) : 3;
   const bool brightObject = (argc >= 4) ? atoi(argv[4]) : true;
-  const double alphaValue = 0.5;
-  const double betaValue = 0.5;
-  const double gammaValue = 0.5;
+  const bool floatPrecision = (argc >= 6) ? atoi(argv[5]) : false;
 
   const unsigned int Dimension = 2;
   typedef double                             PixelType;
@@ -51,22 +80,25 @@ int itkObjectnessMeasureImageFilterTest(int argc, char *argv[])
   SmoothingFilterType::Pointer smoothing = SmoothingFilterType::New();
   smoothing->SetSigma(1.0);
   smoothing->SetInput(reader->GetOutput());
+  smoothing->Update();
 
-  typedef itk::ObjectnessMeasureImageFilter<ImageType, ImageType> FilterType;
-  FilterType::Pointer filter =  FilterType::New();
-  filter->SetInput(smoothing->GetOutput());
-  filter->SetAlpha(alphaValue);
-  filter->SetBeta(betaValue);
-  filter->SetGamma(gammaValue);
-  filter->SetBrightObject(brightObject);
-  filter->SetObjectDimension(objectDimension);
-  filter->SetScaleObjectnessMeasure(false);
+  // the Hessian, eigenvalues and objectness in double or in float
+  typedef itk::ObjectnessMeasureImageFilter<ImageType, ImageType>        FilterType;
+  typedef itk::ObjectnessMeasureImageFilter<ImageType, ImageType, float> FloatFilterType;
 
-  FilterWatcher watcher(filter);
+  ImageType::Pointer output;
+  if ( floatPrecision )
+    {
+    output = ComputeObjectness< FloatFilterType >( smoothing->GetOutput(), objectDimension, brightObject );
+    }
+  else
+    {
+    output = ComputeObjectness< FilterType >( smoothing->GetOutput(), objectDimension, brightObject );
+    }
 
   typedef itk::ImageFileWriter<ImageType> WriterType;
   WriterType::Pointer writer = WriterType::New();
-  writer->SetInput(filter->GetOutput());
+  writer->SetInput(output);
   writer->SetFileName( outputImageFileName );
   writer->Update();
 
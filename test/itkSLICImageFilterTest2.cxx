@@ -17,12 +17,131 @@
  *=========================================================================*/
 
 #include "itkSLICImageFilter.h"
+#include "itkRGBToLabFunctor.h"
 #include "itkVectorImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
 #include "itkRandomImageSource.h"
 
+#include <set>
+
 
 namespace
 {
+
+// The clusters of an RGB image converted by the filter must be the
+// clusters of the image converted to Lab beforehand, and must not
+// mix two colors.
+int TestConvertRGBToLab()
+{
+  const unsigned int VDimension = 2;
+  typedef itk::VectorImage<float, VDimension>  InputImageType;
+  typedef itk::Image<unsigned int, VDimension> OutputImageType;
+
+  typedef itk::FixedArray<float, 3>                   ColorType;
+  typedef itk::Functor::RGBToLab<ColorType, ColorType> RGBToLabType;
+
+  // an orange left half and a blue right half, with a small pattern
+  // so that the colors are not constant
+  InputImageType::RegionType region;
+  InputImageType::SizeType   size = {{60, 40}};
+  region.SetSize( size );
+
+  InputImageType::Pointer rgbImage = InputImageType::New();
+  rgbImage->SetRegions(region);
+  rgbImage->SetVectorLength(3);
+  rgbImage->Allocate();
+
+  InputImageType::Pointer labImage = InputImageType::New();
+  labImage->SetRegions(region);
+  labImage->SetVectorLength(3);
+  labImage->Allocate();
+
+  const unsigned int boundary = 30;
+
+  itk::ImageRegionIteratorWithIndex<InputImageType> it( rgbImage, region );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    const InputImageType::IndexType idx = it.GetIndex();
+    const float pattern = 0.02f * static_cast<float>( ( idx[0] + 3 * idx[1] ) % 5 );
+
+    ColorType rgb;
+    if ( static_cast<unsigned int>( idx[0] ) < boundary )
+      {
+      rgb[0] = 0.95f - pattern;
+      rgb[1] = 0.5f + pattern;
+      rgb[2] = 0.1f;
+      }
+    else
+      {
+      rgb[0] = 0.1f;
+      rgb[1] = 0.2f + pattern;
+      rgb[2] = 0.9f - pattern;
+      }
+
+    InputImageType::PixelType pixel(3);
+    const ColorType lab = RGBToLabType()( rgb );
+    for ( unsigned int c = 0; c < 3; ++c )
+      {
+      pixel[c] = rgb[c];
+      }
+    it.Set( pixel );
+    for ( unsigned int c = 0; c < 3; ++c )
+      {
+      pixel[c] = lab[c];
+      }
+    labImage->SetPixel( idx, pixel );
+    }
+
+  typedef itk::SLICImageFilter< InputImageType, OutputImageType > FilterType;
+
+  FilterType::Pointer rgbFilter = FilterType::New();
+  rgbFilter->SetInput(rgbImage);
+  rgbFilter->SetSuperGridSize(10);
+  rgbFilter->SetSpatialProximityWeight(10.0);
+  rgbFilter->ConvertRGBToLabOn();
+  rgbFilter->Update();
+
+  FilterType::Pointer labFilter = FilterType::New();
+  labFilter->SetInput(labImage);
+  labFilter->SetSuperGridSize(10);
+  labFilter->SetSpatialProximityWeight(10.0);
+  labFilter->Update();
+
+  std::set<unsigned int> leftLabels;
+  std::set<unsigned int> rightLabels;
+
+  itk::ImageRegionConstIteratorWithIndex<OutputImageType> oit( rgbFilter->GetOutput(), region );
+  for ( ; !oit.IsAtEnd(); ++oit )
+    {
+    const OutputImageType::IndexType idx = oit.GetIndex();
+    if ( oit.Get() != labFilter->GetOutput()->GetPixel( idx ) )
+      {
+      std::cerr << "Label at " << idx << " is " << oit.Get() << " with ConvertRGBToLab and "
+                << labFilter->GetOutput()->GetPixel( idx ) << " for the Lab input" << std::endl;
+      return EXIT_FAILURE;
+      }
+    if ( static_cast<unsigned int>( idx[0] ) < boundary )
+      {
+      leftLabels.insert( oit.Get() );
+      }
+    else
+      {
+      rightLabels.insert( oit.Get() );
+      }
+    }
+
+  for ( std::set<unsigned int>::const_iterator l = leftLabels.begin(); l != leftLabels.end(); ++l )
+    {
+    if ( rightLabels.count( *l ) )
+      {
+      std::cerr << "Label " << *l << " covers both colors" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
+
 }
 
 int itkSLICImageFilterTest2(int, char *[])
@@ -67,5 +186,29 @@ int itkSLICImageFilterTest2(int, char *[])
 
   filter->GetOutput()->Print(std::cout);
 
+  // check conversion of a RGB input to Lab
+  if ( TestConvertRGBToLab() == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+
+  region.SetSize( size );
+  input->SetRegions(region);
+  filter->ConvertRGBToLabOn();
+
+  // check that the conversion requires 3 components
+  input->SetVectorLength(2);
+  input->Allocate();
+  try
+    {
+    filter->Update();
+    std::cerr << "Expected exception with 2 component input!" << std::endl;
+    return EXIT_FAILURE;
+    }
+  catch (itk::ExceptionObject &e)
+    {
+    std::cout << "Caught expected exception: " << e.GetDescription() << std::endl;
+    }
+
   return 0;
 }
@@ -0,0 +1,208 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkSliceImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkVectorImage.h"
+#include "itkTimeProbe.h"
+
+#include <cstdlib>
+
+//
+// Times SliceImageFilter on a float volume with the same step in all
+// dimensions, against the pixel by pixel copy, for example:
+//   itkSliceImageFilterBenchmark 256 256 256 5
+//   itkSliceImageFilterBenchmark 512 512 512 3
+//   itkSliceImageFilterBenchmark 256 256 256 3 6
+//
+// then the reversal of x, y and z, which are the blocked reversed
+// copy for x and forward scanline copies for y and z, followed by the
+// steps on a VectorImage with 3 components by default.
+//
+namespace
+{
+
+typedef itk::Image< float, 3 >       BenchmarkImageType;
+typedef itk::VectorImage< float, 3 > BenchmarkVectorImageType;
+
+// The pixel by pixel copy used before the scanline copy
+template< typename TImage >
+class SliceByPixelFilter
+  : public itk::SliceImageFilter< TImage, TImage >
+{
+public:
+  typedef SliceByPixelFilter                      Self;
+  typedef itk::SliceImageFilter< TImage, TImage > Superclass;
+  typedef itk::SmartPointer< Self >               Pointer;
+
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+
+  itkNewMacro(Self);
+
+protected:
+  void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                             itk::ThreadIdType threadId ) ITK_OVERRIDE
+    {
+      itk::ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+      this->ThreadedGenerateDataByPixel( outputRegionForThread, progress );
+    }
+};
+
+template< typename TImage >
+void TimeSlice( const char *name, itk::SliceImageFilter< TImage, TImage > *filter, const TImage *image,
+                int step, unsigned int iterations )
+{
+  typedef itk::SliceImageFilter< TImage, TImage > FilterType;
+
+  filter->SetInput( image );
+  filter->SetStep( step );
+  if ( step < 0 )
+    {
+    filter->SetStart( itk::NumericTraits< typename FilterType::IndexValueType >::max() );
+    filter->SetStop( itk::NumericTraits< typename FilterType::IndexValueType >::min() );
+    }
+
+  itk::TimeProbe probe;
+  for ( unsigned int i = 0; i < iterations; ++i )
+    {
+    filter->Modified();
+    probe.Start();
+    filter->Update();
+    probe.Stop();
+    }
+
+  const double voxels = static_cast< double >( filter->GetOutput()->GetLargestPossibleRegion().GetNumberOfPixels() );
+  const double seconds = probe.GetMean();
+  const double bytesPerVoxel = 2.0 * sizeof( typename TImage::InternalPixelType ) * image->GetNumberOfComponentsPerPixel();
+
+  std::cout << name << " step " << step << ": " << seconds << " s, "
+            << 1e9 * seconds / voxels << " ns/voxel, "
+            << bytesPerVoxel * voxels / seconds / ( 1024.0 * 1024.0 * 1024.0 ) << " GB/s" << std::endl;
+}
+
+// Times the reversal of one dimension, with a step of 1 in the others
+template< typename TImage >
+void TimeFlip( const char *name, itk::SliceImageFilter< TImage, TImage > *filter, const TImage *image,
+               unsigned int dimension, unsigned int iterations )
+{
+  typedef itk::SliceImageFilter< TImage, TImage > FilterType;
+
+  typename FilterType::ArrayType step;
+  step.Fill( 1 );
+  step[dimension] = -1;
+
+  typename FilterType::IndexType start = image->GetLargestPossibleRegion().GetIndex();
+  typename FilterType::IndexType stop = image->GetLargestPossibleRegion().GetUpperIndex();
+  for ( unsigned int i = 0; i < TImage::ImageDimension; ++i )
+    {
+    ++stop[i];
+    }
+  start[dimension] = stop[dimension] - 1;
+  stop[dimension] = image->GetLargestPossibleRegion().GetIndex( dimension ) - 1;
+
+  filter->SetInput( image );
+  filter->SetStep( step );
+  filter->SetStart( start );
+  filter->SetStop( stop );
+
+  itk::TimeProbe probe;
+  for ( unsigned int i = 0; i < iterations; ++i )
+    {
+    filter->Modified();
+    probe.Start();
+    filter->Update();
+    probe.Stop();
+    }
+
+  const double voxels = static_cast< double >( filter->GetOutput()->GetLargestPossibleRegion().GetNumberOfPixels() );
+  const double seconds = probe.GetMean();
+  const double bytesPerVoxel = 2.0 * sizeof( typename TImage::InternalPixelType ) * image->GetNumberOfComponentsPerPixel();
+  const char axes[] = "xyz";
+
+  std::cout << name << " flip " << axes[dimension] << ": " << seconds << " s, "
+            << 1e9 * seconds / voxels << " ns/voxel, "
+            << bytesPerVoxel * voxels / seconds / ( 1024.0 * 1024.0 * 1024.0 ) << " GB/s" << std::endl;
+}
+
+}
+
+int itkSliceImageFilterBenchmark( int argc, char *argv[] )
+{
+  if ( argc < 4 )
+    {
+    std::cerr << "Usage: " << argv[0] << " sizeX sizeY sizeZ [iterations] [components]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  BenchmarkImageType::SizeType size;
+  for ( unsigned int i = 0; i < 3; ++i )
+    {
+    size[i] = atoi( argv[i+1] );
+    }
+  const unsigned int iterations = ( argc > 4 ) ? atoi( argv[4] ) : 3;
+  const unsigned int components = ( argc > 5 ) ? atoi( argv[5] ) : 3;
+
+  BenchmarkImageType::Pointer image = BenchmarkImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+
+  itk::ImageRegionIterator< BenchmarkImageType > it( image, image->GetLargestPossibleRegion() );
+  for ( unsigned int n = 0; !it.IsAtEnd(); ++it, ++n )
+    {
+    it.Set( static_cast< float >( ( n * 2654435761u ) % 1024 ) );
+    }
+
+  BenchmarkVectorImageType::Pointer vectorImage = BenchmarkVectorImageType::New();
+  vectorImage->SetRegions( size );
+  vectorImage->SetNumberOfComponentsPerPixel( components );
+  vectorImage->Allocate();
+
+  float *vectorBuffer = vectorImage->GetBufferPointer();
+  const itk::SizeValueType vectorLength = vectorImage->GetLargestPossibleRegion().GetNumberOfPixels() * components;
+  for ( itk::SizeValueType n = 0; n < vectorLength; ++n )
+    {
+    vectorBuffer[n] = static_cast< float >( ( n * 2654435761u ) % 1024 );
+    }
+
+  std::cout << "Image size: " << size << " iterations: " << iterations << std::endl;
+
+  typedef itk::SliceImageFilter< BenchmarkImageType, BenchmarkImageType >             SliceFilterType;
+  typedef itk::SliceImageFilter< BenchmarkVectorImageType, BenchmarkVectorImageType > VectorSliceFilterType;
+
+  const int steps[] = { 1, 2, -1, 4 };
+  for ( unsigned int s = 0; s < sizeof( steps ) / sizeof( steps[0] ); ++s )
+    {
+    TimeSlice< BenchmarkImageType >( "Pixels", SliceByPixelFilter< BenchmarkImageType >::New(), image, steps[s], iterations );
+    TimeSlice< BenchmarkImageType >( "Scanlines", SliceFilterType::New(), image, steps[s], iterations );
+    }
+
+  std::cout << "Flips" << std::endl;
+  for ( unsigned int d = 0; d < 3; ++d )
+    {
+    TimeFlip< BenchmarkImageType >( "Pixels", SliceByPixelFilter< BenchmarkImageType >::New(), image, d, iterations );
+    TimeFlip< BenchmarkImageType >( "Scanlines", SliceFilterType::New(), image, d, iterations );
+    }
+
+  std::cout << "VectorImage with " << components << " components" << std::endl;
+  for ( unsigned int s = 0; s < sizeof( steps ) / sizeof( steps[0] ); ++s )
+    {
+    TimeSlice< BenchmarkVectorImageType >( "Pixels", SliceByPixelFilter< BenchmarkVectorImageType >::New(), vectorImage, steps[s], iterations );
+    TimeSlice< BenchmarkVectorImageType >( "Components", VectorSliceFilterType::New(), vectorImage, steps[s], iterations );
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -23,6 +23,11 @@
 #include "itkPhysicalPointImageSource.h"
 #include "itkGaussianImageSource.h"
 #include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkVectorImage.h"
+#include "itkCommand.h"
+
+#include <vector>
 
 
 // This test verifies the principle that the SliceImageFilter should
@@ -80,6 +85,30 @@ typename TImageType::Pointer RunFilter( const TImageType *img,
   return sliceFilter->GetOutput();
 }
 
+// Records the progress of a filter
+class ProgressRecorder
+  : public itk::Command
+{
+public:
+  typedef ProgressRecorder          Self;
+  typedef itk::Command              Superclass;
+  typedef itk::SmartPointer< Self > Pointer;
+
+  itkNewMacro(Self);
+
+  void Execute( itk::Object *caller, const itk::EventObject & event ) ITK_OVERRIDE
+    {
+      this->Execute( const_cast< const itk::Object * >( caller ), event );
+    }
+
+  void Execute( const itk::Object *caller, const itk::EventObject & ) ITK_OVERRIDE
+    {
+      m_Progress.push_back( static_cast< const itk::ProcessObject * >( caller )->GetProgress() );
+    }
+
+  std::vector< float > m_Progress;
+};
+
 
 }
 
@@ -374,3 +403,314 @@ TEST(SliceImageFilterTests,ExceptionalCases)
   EXPECT_EQ( 0u, filter->GetOutput()->GetLargestPossibleRegion().GetNumberOfPixels() );
 
 }
+
+
+TEST(SliceImageFilterTests,Scanlines)
+{
+  const unsigned int ImageDimension = 3;
+  typedef itk::Image<short, ImageDimension> InputImageType;
+  typedef itk::Image<float, ImageDimension> OutputImageType;
+
+  InputImageType::SizeType size = {{13,11,7}};
+  InputImageType::IndexType index = {{-3,2,5}};
+  InputImageType::RegionType region( index, size );
+
+  InputImageType::Pointer image = InputImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+
+  itk::ImageRegionIterator<InputImageType> it( image, region );
+  for ( short n = 0; !it.IsAtEnd(); ++it, ++n )
+    {
+    it.Set( n );
+    }
+
+  typedef itk::SliceImageFilter<InputImageType, OutputImageType> FilterType;
+
+  // unit, strided and reversed steps along the scanlines
+  const int steps[][ImageDimension] = { {1,1,1}, {2,1,3}, {-1,2,1}, {-3,-1,-2}, {5,-2,1} };
+
+  for ( unsigned int s = 0; s < sizeof(steps)/sizeof(steps[0]); ++s )
+    {
+    FilterType::ArrayType step;
+    InputImageType::IndexType start;
+    InputImageType::IndexType stop;
+    for ( unsigned int i = 0; i < ImageDimension; ++i )
+      {
+      step[i] = steps[s][i];
+      start[i] = ( step[i] > 0 ) ? index[i] + 1 : index[i] + size[i] - 2;
+      stop[i] = ( step[i] > 0 ) ? index[i] + size[i] : index[i] - 1;
+      }
+
+    FilterType::Pointer filter = FilterType::New();
+    filter->SetInput( image );
+    filter->SetStart( start );
+    filter->SetStop( stop );
+    filter->SetStep( step );
+    filter->Update();
+
+    const OutputImageType *output = filter->GetOutput();
+    ASSERT_GT( output->GetBufferedRegion().GetNumberOfPixels(), 0u );
+
+    itk::ImageRegionConstIterator<OutputImageType> oit( output, output->GetBufferedRegion() );
+    for ( ; !oit.IsAtEnd(); ++oit )
+      {
+      InputImageType::IndexType srcIndex;
+      for ( unsigned int i = 0; i < ImageDimension; ++i )
+        {
+        srcIndex[i] = oit.GetIndex()[i] * step[i] + start[i];
+        }
+      ASSERT_EQ( static_cast<float>( image->GetPixel( srcIndex ) ), oit.Get() )
+        << "Step: " << step << " Index: " << oit.GetIndex();
+      }
+    }
+}
+
+TEST(SliceImageFilterTests,View)
+{
+  const unsigned int ImageDimension = 2;
+  typedef itk::Point<double, ImageDimension>    PixelType;
+  typedef itk::Image<PixelType, ImageDimension> ImageType;
+
+  typedef itk::PhysicalPointImageSource<ImageType> SourceType;
+  SourceType::Pointer source = SourceType::New();
+
+  SourceType::SizeValueType size[] = {64,63};
+  source->SetSize( size );
+
+  // the source produces the requested region of the input
+  const ImageType *input = source->GetOutput();
+
+  typedef itk::SliceImageFilter<ImageType, ImageType> FilterType;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( input );
+  filter->SetStart( 5 );
+  filter->SetStop( 40 );
+  EXPECT_FALSE( filter->GetAllowView() );
+  filter->AllowViewOn();
+  filter->Update();
+
+  const ImageType *output = filter->GetOutput();
+  EXPECT_EQ( input->GetBufferPointer(), output->GetBufferPointer() ) << "Unit steps share the buffer";
+  EXPECT_EQ( 35u, output->GetLargestPossibleRegion().GetSize()[0] );
+  EXPECT_EQ( output->GetLargestPossibleRegion(), output->GetBufferedRegion() );
+
+  // the view matches the physical points over its largest region
+  typedef itk::ImageRegionConstIterator<ImageType> IteratorType;
+  IteratorType it( output, output->GetLargestPossibleRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    ImageType::PointType pt;
+    output->TransformIndexToPhysicalPoint( it.GetIndex(), pt );
+    for ( unsigned int i = 0; i < ImageDimension; ++i )
+      {
+      ASSERT_DOUBLE_EQ( pt[i], it.Get()[i] ) << "Index: " << it.GetIndex();
+      }
+    }
+
+  // an input buffered beyond the requested region is copied, so the
+  // buffered region stays the requested region
+  source->UpdateLargestPossibleRegion();
+  filter->Modified();
+  filter->Update();
+  EXPECT_NE( input->GetBufferPointer(), filter->GetOutput()->GetBufferPointer() ) << "Larger buffers are copied";
+  EXPECT_EQ( filter->GetOutput()->GetLargestPossibleRegion(), filter->GetOutput()->GetBufferedRegion() );
+  EXPECT_TRUE( CheckValueIsPhysicalPoint( filter->GetOutput() ) );
+
+  // a step other than 1 forces a copy
+  filter->SetStep( 2 );
+  filter->Update();
+  EXPECT_NE( input->GetBufferPointer(), filter->GetOutput()->GetBufferPointer() ) << "Strided slices are copied";
+  EXPECT_TRUE( CheckValueIsPhysicalPoint( filter->GetOutput() ) );
+
+  // without AllowView unit steps are copied
+  filter->SetStep( 1 );
+  filter->AllowViewOff();
+  filter->Update();
+  EXPECT_NE( input->GetBufferPointer(), filter->GetOutput()->GetBufferPointer() ) << "Views are not allowed";
+  EXPECT_TRUE( CheckValueIsPhysicalPoint( filter->GetOutput() ) );
+}
+
+TEST(SliceImageFilterTests,SparseInputRequests)
+{
+  const unsigned int ImageDimension = 3;
+  typedef itk::Point<double, ImageDimension>    PixelType;
+  typedef itk::Image<PixelType, ImageDimension> ImageType;
+
+  typedef itk::PhysicalPointImageSource<ImageType> SourceType;
+  SourceType::Pointer source = SourceType::New();
+
+  SourceType::SizeValueType size[] = {16,15,40};
+  source->SetSize( size );
+
+  typedef itk::SliceImageFilter<ImageType, ImageType> FilterType;
+
+  const int lastSteps[] = { 8, -7, 3 };
+  for ( unsigned int s = 0; s < sizeof(lastSteps)/sizeof(lastSteps[0]); ++s )
+    {
+    FilterType::ArrayType step;
+    step[0] = 1;
+    step[1] = 2;
+    step[2] = lastSteps[s];
+
+    FilterType::Pointer filter = FilterType::New();
+    filter->SetInput( source->GetOutput() );
+    filter->SetStep( step );
+    if ( step[2] < 0 )
+      {
+      filter->SetStart( 38 );
+      filter->SetStop( -1 );
+      }
+    filter->SparseInputRequestsOn();
+
+    ProgressRecorder::Pointer recorder = ProgressRecorder::New();
+    filter->AddObserver( itk::ProgressEvent(), recorder );
+    filter->Update();
+
+    EXPECT_TRUE( CheckValueIsPhysicalPoint( filter->GetOutput() ) ) << "Step: " << step;
+
+    // the progress of the slices adds up instead of restarting at 0
+    ASSERT_FALSE( recorder->m_Progress.empty() );
+    for ( size_t i = 1; i < recorder->m_Progress.size(); ++i )
+      {
+      EXPECT_LE( recorder->m_Progress[i-1], recorder->m_Progress[i] ) << "Step: " << step << " event: " << i;
+      }
+    EXPECT_FLOAT_EQ( 1.0f, recorder->m_Progress.back() ) << "Step: " << step;
+
+    // only the last needed slice remains in the source's buffer
+    EXPECT_EQ( 1u, source->GetOutput()->GetBufferedRegion().GetSize()[2] ) << "Step: " << step;
+
+    const ImageType::SizeValueType slices = filter->GetOutput()->GetLargestPossibleRegion().GetSize()[2];
+    ASSERT_GT( slices, 1u );
+    }
+
+  // the bounding box is requested by default
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( source->GetOutput() );
+  filter->SetStep( 8 );
+  filter->Update();
+  EXPECT_EQ( 33u, source->GetOutput()->GetBufferedRegion().GetSize()[2] );
+  EXPECT_TRUE( CheckValueIsPhysicalPoint( filter->GetOutput() ) );
+}
+
+TEST(SliceImageFilterTests,VectorImage)
+{
+  const unsigned int ImageDimension = 3;
+  typedef itk::VectorImage<short, ImageDimension> InputImageType;
+  typedef itk::VectorImage<float, ImageDimension> OutputImageType;
+
+  const unsigned int components = 3;
+
+  InputImageType::SizeType size = {{13,11,7}};
+  InputImageType::IndexType index = {{2,-1,0}};
+  InputImageType::RegionType region( index, size );
+
+  InputImageType::Pointer image = InputImageType::New();
+  image->SetRegions( region );
+  image->SetNumberOfComponentsPerPixel( components );
+  image->Allocate();
+
+  short *buffer = image->GetBufferPointer();
+  for ( itk::SizeValueType n = 0; n < region.GetNumberOfPixels() * components; ++n )
+    {
+    buffer[n] = static_cast<short>( n );
+    }
+
+  typedef itk::SliceImageFilter<InputImageType, OutputImageType> FilterType;
+
+  // the contiguous, strided and reversed copies of the components
+  const int steps[][ImageDimension] = { {1,1,1}, {3,1,2}, {-1,1,-1}, {-2,3,1} };
+
+  for ( unsigned int s = 0; s < sizeof(steps)/sizeof(steps[0]); ++s )
+    {
+    FilterType::ArrayType step;
+    InputImageType::IndexType start;
+    InputImageType::IndexType stop;
+    for ( unsigned int i = 0; i < ImageDimension; ++i )
+      {
+      step[i] = steps[s][i];
+      start[i] = ( step[i] > 0 ) ? index[i] : index[i] + size[i] - 1;
+      stop[i] = ( step[i] > 0 ) ? index[i] + size[i] : index[i] - 1;
+      }
+
+    FilterType::Pointer filter = FilterType::New();
+    filter->SetInput( image );
+    filter->SetStart( start );
+    filter->SetStop( stop );
+    filter->SetStep( step );
+    filter->Update();
+
+    const OutputImageType *output = filter->GetOutput();
+    ASSERT_EQ( components, output->GetNumberOfComponentsPerPixel() );
+
+    itk::ImageRegionConstIterator<OutputImageType> oit( output, output->GetBufferedRegion() );
+    for ( ; !oit.IsAtEnd(); ++oit )
+      {
+      InputImageType::IndexType srcIndex;
+      for ( unsigned int i = 0; i < ImageDimension; ++i )
+        {
+        srcIndex[i] = oit.GetIndex()[i] * step[i] + start[i];
+        }
+      const InputImageType::PixelType expected = image->GetPixel( srcIndex );
+      const OutputImageType::PixelType value = oit.Get();
+      for ( unsigned int c = 0; c < components; ++c )
+        {
+        ASSERT_EQ( static_cast<float>( expected[c] ), value[c] )
+          << "Step: " << step << " Index: " << oit.GetIndex() << " Component: " << c;
+        }
+      }
+    }
+}
+
+TEST(SliceImageFilterTests,ReversedScanlines)
+{
+  const unsigned int ImageDimension = 2;
+  typedef itk::Image<int, ImageDimension> ImageType;
+
+  ImageType::SizeType size = {{41,3}};
+  ImageType::IndexType index = {{-5,0}};
+  ImageType::RegionType region( index, size );
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+
+  itk::ImageRegionIterator<ImageType> it( image, region );
+  for ( int n = 0; !it.IsAtEnd(); ++it, ++n )
+    {
+    it.Set( n );
+    }
+
+  typedef itk::SliceImageFilter<ImageType, ImageType> FilterType;
+
+  // lines shorter than, equal to, and not a multiple of the blocks
+  // of the reversed copy
+  for ( unsigned int length = 1; length <= size[0]; ++length )
+    {
+    ImageType::IndexType start = {{index[0] + static_cast<int>( length ) - 1, index[1]}};
+    ImageType::IndexType stop = {{index[0] - 1, index[1] + static_cast<int>( size[1] )}};
+    FilterType::ArrayType step;
+    step[0] = -1;
+    step[1] = 1;
+
+    FilterType::Pointer filter = FilterType::New();
+    filter->SetInput( image );
+    filter->SetStart( start );
+    filter->SetStop( stop );
+    filter->SetStep( step );
+    filter->Update();
+
+    const ImageType *output = filter->GetOutput();
+    ASSERT_EQ( length, output->GetBufferedRegion().GetSize()[0] );
+
+    itk::ImageRegionConstIterator<ImageType> oit( output, output->GetBufferedRegion() );
+    for ( ; !oit.IsAtEnd(); ++oit )
+      {
+      ImageType::IndexType srcIndex;
+      srcIndex[0] = start[0] - oit.GetIndex()[0];
+      srcIndex[1] = start[1] + oit.GetIndex()[1];
+      ASSERT_EQ( image->GetPixel( srcIndex ), oit.Get() )
+        << "Length: " << length << " Index: " << oit.GetIndex();
+      }
+    }
+}
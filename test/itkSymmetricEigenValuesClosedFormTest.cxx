@@ -0,0 +1,137 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+#include "itkSymmetricEigenValuesClosedForm.h"
+#include "itkSymmetricSecondRankTensor.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+namespace
+{
+
+// uniform values in [-1,1) from a linear congruential generator
+double NextRandom( unsigned int &state )
+{
+  state = state * 1664525u + 1013904223u;
+  return state / 2147483648.0 - 1.0;
+}
+
+// Compare the closed form with SymmetricEigenAnalysis on random
+// tensors, tensors with repeated eigenvalues and diagonal tensors.
+template< unsigned int VDimension >
+void CheckClosedFormEigenValues( void )
+{
+  typedef itk::SymmetricSecondRankTensor< double, VDimension >  TensorType;
+  typedef typename TensorType::EigenValuesArrayType              EigenValuesArrayType;
+  typedef itk::SymmetricEigenValuesClosedForm< double, VDimension > ClosedFormType;
+
+  unsigned int state = 1;
+
+  const unsigned int numberOfTensors = 10000;
+  std::vector< TensorType > tensors( numberOfTensors );
+  for ( unsigned int n = 0; n < numberOfTensors; ++n )
+    {
+    for ( unsigned int k = 0; k < TensorType::Length; ++k )
+      {
+      tensors[n][k] = NextRandom( state ) * ( n % 5 + 1 );
+      }
+    if ( n % 7 == 0 )
+      {
+      // a multiple of the identity plus a rank one matrix
+      tensors[n].Fill( 0.0 );
+      for ( unsigned int i = 0; i < VDimension; ++i )
+        {
+        for ( unsigned int j = i; j < VDimension; ++j )
+          {
+          tensors[n]( i, j ) = ( i == j ? 2.0 : 0.0 ) + ( i + 1.0 ) * ( j + 1.0 ) * ( n % 3 );
+          }
+        }
+      }
+    if ( n % 11 == 0 )
+      {
+      for ( unsigned int i = 0; i < VDimension; ++i )
+        {
+        for ( unsigned int j = i + 1; j < VDimension; ++j )
+          {
+          tensors[n]( i, j ) = 0.0;
+          }
+        }
+      }
+    }
+
+  std::vector< EigenValuesArrayType > eigenValues( numberOfTensors );
+  ClosedFormType::ComputeEigenValues( tensors[0].GetDataPointer(), eigenValues[0].GetDataPointer(), numberOfTensors );
+
+  for ( unsigned int n = 0; n < numberOfTensors; ++n )
+    {
+    EigenValuesArrayType expected;
+    tensors[n].ComputeEigenValues( expected );
+
+    EigenValuesArrayType single;
+    ClosedFormType::ComputeEigenValues( tensors[n], single );
+
+    double norm = 0.0;
+    for ( unsigned int i = 0; i < VDimension; ++i )
+      {
+      norm += expected[i] * expected[i];
+      }
+    norm = std::sqrt( norm );
+
+    for ( unsigned int i = 0; i < VDimension; ++i )
+      {
+      EXPECT_NEAR( expected[i], eigenValues[n][i], 1e-7 * norm + 1e-12 ) << "tensor: " << tensors[n];
+      EXPECT_EQ( eigenValues[n][i], single[i] );
+      }
+    }
+}
+
+}
+
+TEST(SymmetricEigenValuesClosedFormTest, Test2D)
+{
+  CheckClosedFormEigenValues<2>();
+
+  itk::SymmetricSecondRankTensor< double, 2 > t;
+  t(0,0) = 3.0;
+  t(0,1) = 0.0;
+  t(1,1) = -1.0;
+
+  itk::FixedArray< double, 2 > e;
+  itk::SymmetricEigenValuesClosedForm< double, 2 >::ComputeEigenValues( t, e );
+  EXPECT_DOUBLE_EQ( -1.0, e[0] );
+  EXPECT_DOUBLE_EQ( 3.0, e[1] );
+}
+
+TEST(SymmetricEigenValuesClosedFormTest, Test3D)
+{
+  CheckClosedFormEigenValues<3>();
+
+  itk::SymmetricSecondRankTensor< double, 3 > t;
+  t.Fill( 0.0 );
+  t(0,0) = 2.0;
+  t(1,1) = 2.0;
+  t(2,2) = 2.0;
+
+  itk::FixedArray< double, 3 > e;
+  itk::SymmetricEigenValuesClosedForm< double, 3 >::ComputeEigenValues( t, e );
+  EXPECT_DOUBLE_EQ( 2.0, e[0] );
+  EXPECT_DOUBLE_EQ( 2.0, e[1] );
+  EXPECT_DOUBLE_EQ( 2.0, e[2] );
+}